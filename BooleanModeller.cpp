@@ -1,4 +1,10 @@
 #include "BooleanModeller.hpp"
+#include "WindingNumber.hpp"
+#include "Trace.hpp"
+#include "FragmentMerger.hpp"
+#include "EdgeCollapser.hpp"
+#include "IntersectionCurves.hpp"
+#include "VertexWelder.hpp"
 #include <algorithm>
 
 /**
@@ -15,17 +21,47 @@
  * @author Danilo Balby Silva Castanheira (danbalby@yahoo.com)
  * Translated to C++ by akatsia-games on github.com
  */
-BooleanModeller::BooleanModeller(const Solid& solid1, const Solid& solid2)
+
+/**
+ * Constructs a BooleanModeller object to apply bool operations on two solids.
+ * 
+ * @param solid1 first solid
+ * @param solid2 second solid
+ * @param classification method used to classify the faces: RAY_TRACE or WINDING_NUMBER
+ * @param splitting method used to split the faces: INCREMENTAL_SPLIT or BATCHED_SPLIT
+ */
+BooleanModeller::BooleanModeller(const Solid& solid1, const Solid& solid2, int classification, int splitting)
 	:object1(solid1)
 	,object2(solid2)
+	,numSources1(solid1.getIndices().size()/3)
 {
+	TRACE_SCOPE("BooleanModeller::BooleanModeller");
 	//split the faces so that none of them intercepts each other
-	object1.splitFaces(object2);
-	object2.splitFaces(object1);
+	if(splitting == BATCHED_SPLIT)
+	{
+		object1.splitFacesBatched(object2);
+		object2.splitFacesBatched(object1);
+	}
+	else
+	{
+		object1.splitFaces(object2);
+		object2.splitFaces(object1);
+	}
 
 	//classify faces as being inside or outside the other solid
-	object1.classifyFaces(object2);
-	object2.classifyFaces(object1);
+	if(classification == WINDING_NUMBER)
+	{
+		WindingNumber windingNumber2(object2);
+		object1.classifyFaces(windingNumber2);
+		
+		WindingNumber windingNumber1(object1);
+		object2.classifyFaces(windingNumber1);
+	}
+	else
+	{
+		object1.classifyFaces(object2);
+		object2.classifyFaces(object1);
+	}
 }
 
 //-------------------------------BOOLEAN_OPERATIONS-----------------------------//
@@ -35,9 +71,9 @@ BooleanModeller::BooleanModeller(const Solid& solid1, const Solid& solid2)
 	*
 	* @return solid generated by the union of the two solids submitted to the constructor
 	*/
-Solid BooleanModeller::getUnion()
+Solid BooleanModeller::getUnion() const
 {
-	return composeSolid(Face::OUTSIDE, Face::SAME, Face::OUTSIDE);
+	return composeSolids(UNION)[0];
 }
 
 /**
@@ -47,9 +83,9 @@ Solid BooleanModeller::getUnion()
 	* The generated solid may be empty depending on the solids. In this case, it can't be used on a scene
 	* graph. To check this, use the Solid.isEmpty() method.
 	*/
-Solid BooleanModeller::getIntersection()
+Solid BooleanModeller::getIntersection() const
 {
-	return composeSolid(Face::INSIDE, Face::SAME, Face::INSIDE);
+	return composeSolids(INTERSECTION)[0];
 }
 
 /** Gets the solid generated by the difference of the two solids submitted to the constructor.
@@ -57,84 +93,374 @@ Solid BooleanModeller::getIntersection()
 	*
 	* @return solid generated by the difference of the two solids submitted to the constructor
 	*/
-Solid BooleanModeller::getDifference()
+Solid BooleanModeller::getDifference() const
 {
-	object2.invertInsideFaces();
-	Solid result = composeSolid(Face::OUTSIDE, Face::OPPOSITE, Face::INSIDE);
-	object2.invertInsideFaces();
+	return composeSolids(DIFFERENCE)[0];
+}
 
-	return result;
+/**
+	* Gets the solids generated by several bool operations at once. The faces of both
+	* solids are scanned once, and their vertices welded once for all the results, so
+	* each further result costs little more than its own copy.
+	*
+	* @param operations mask of UNION, INTERSECTION and DIFFERENCE
+	* @return one solid per operation in the mask, in the order union, intersection, difference
+	*/
+std::vector<Solid> BooleanModeller::getSolids(int operations) const
+{
+	return composeSolids(operations);
 }
 
-//--------------------------PRIVATES--------------------------------------------//
+//------------------------------------QUERIES-----------------------------------//
+
+/**
+ * Checks if two solids overlap in volume, without computing their intersection.
+ * 
+ * <br><br>Stops at the first pair of crossing triangles (see IntersectionCurves::crosses).
+ * If their surfaces don't cross, the solids are apart or one is inside the other,
+ * which is told by the winding number of a vertex of each against the other.
+ * 
+ * @param solid1 first solid
+ * @param solid2 second solid
+ * @return true if the solids overlap (solids only touching may count as overlapping)
+ */
+bool BooleanModeller::interfere(const Solid& solid1, const Solid& solid2)
+{
+	TRACE_SCOPE("BooleanModeller::interfere");
+	if(solid1.isEmpty() || solid2.isEmpty())
+	{
+		return false;
+	}
+	Bound bound1 = solid1.getBound();
+	Bound bound2 = solid2.getBound();
+	if(!bound1.overlap(bound2))
+	{
+		return false;
+	}
+	if(IntersectionCurves::crosses(solid1, solid2))
+	{
+		return true;
+	}
+	
+	//a solid can only be inside the other if its bound is
+	const Point3f& vertex1 = solid1.getVertices()[solid1.getIndices()[0]];
+	const Point3f& vertex2 = solid2.getVertices()[solid2.getIndices()[0]];
+	return (bound2.contains(vertex1) && WindingNumber(solid2).isInside(vertex1)) ||
+		(bound1.contains(vertex2) && WindingNumber(solid1).isInside(vertex2));
+}
 
 /**
-	* Composes a solid based on the faces status of the two operators solids:
-	* Face::INSIDE, Face::OUTSIDE, Face::SAME, Face::OPPOSITE
+ * Gets the volume, centroid and inertia of the result of a bool operation, summing
+ * the faces that would make it up without composing the solid. The faces of the
+ * second solid substracted are taken inverted.
+ * 
+ * @param operation UNION, INTERSECTION or DIFFERENCE
+ * @return volume integrals, taken from the center of the first solid bound
+ */
+MassProperties BooleanModeller::getMassProperties(int operation) const
+{
+	TRACE_SCOPE("BooleanModeller::getMassProperties");
+	Point3f min = object1.getBound().getMin();
+	Point3f max = object1.getBound().getMax();
+	MassProperties properties(Point3f((min.x+max.x)/2, (min.y+max.y)/2, (min.z+max.z)/2));
+	for(int objectNumber=0;objectNumber<2;objectNumber++)
+	{
+		const Object3D& object = objectNumber==0 ? object1 : object2;
+		for(int i=0;i<object.getNumFaces();i++)
+		{
+			const Face& face = object.getFace(i);
+			int orientation = getFaceOrientation(operation, objectNumber==0, face.getStatus());
+			if(orientation>0)
+			{
+				properties.addTriangle(face.v1().getPosition(), face.v2().getPosition(), face.v3().getPosition());
+			}
+			else if(orientation<0)
+			{
+				properties.addTriangle(face.v2().getPosition(), face.v1().getPosition(), face.v3().getPosition());
+			}
+		}
+	}
+	return properties;
+}
+
+/**
+	* Gets how a face goes into the solid resulting from a bool operation
 	*
-	* @param faceStatus1 status expected for the first solid faces
-	* @param faceStatus2 other status expected for the first solid faces
-	* (expected a status for the faces coincident with second solid faces)
-	* @param faceStatus3 status expected for the second solid faces
+	* @param operation UNION, INTERSECTION or DIFFERENCE
+	* @param firstObject true for the faces of the first solid, false for the second
+	* @param faceStatus status of the face relative to the other solid
+	* @return 1 if the face is taken as it is, -1 if it is taken inverted, 0 if it isn't taken
 	*/
-Solid BooleanModeller::composeSolid(int faceStatus1, int faceStatus2, int faceStatus3)
+int BooleanModeller::getFaceOrientation(int operation, bool firstObject, int faceStatus)
 {
-	std::vector<Vertex> vertices;
-	std::vector<int> indices;
-	std::vector<Colour3f> colors;
+	if(operation==UNION)
+	{
+		return (firstObject ? faceStatus==Face::OUTSIDE || faceStatus==Face::SAME : faceStatus==Face::OUTSIDE) ? 1 : 0;
+	}
+	else if(operation==INTERSECTION)
+	{
+		return (firstObject ? faceStatus==Face::INSIDE || faceStatus==Face::SAME : faceStatus==Face::INSIDE) ? 1 : 0;
+	}
+	else if(operation==DIFFERENCE)
+	{
+		if(firstObject)
+		{
+			return faceStatus==Face::OUTSIDE || faceStatus==Face::OPPOSITE ? 1 : 0;
+		}
+		return faceStatus==Face::INSIDE ? -1 : 0;
+	}
+	return 0;
+}
 
-	//group the elements of the two solids whose faces fit with the desired status
-	groupObjectComponents(object1, vertices, indices, colors, faceStatus1, faceStatus2);
-	groupObjectComponents(object2, vertices, indices, colors, faceStatus3, faceStatus3);
+//---------------------------------STATISTICS-----------------------------------//
 
-	//turn the Vertex vector to Point3f vector
-	std::vector<Point3f> verticesArray(vertices.size());
-	for(int i=0;i<vertices.size();i++)
+/**
+ * Gets the counters and stage times of both solids, with the time of the last
+ * composition (union, intersection or difference)
+ * 
+ * @return statistics of the bool operation
+ */
+BooleanStatistics BooleanModeller::getStatistics() const
+{
+	const BooleanStatistics& statistics1 = object1.getStatistics();
+	const BooleanStatistics& statistics2 = object2.getStatistics();
+	BooleanStatistics statistics = statistics1;
+	statistics.add(statistics2);
+	
+	//the objects go through each stage one after the other: the peak is reached either
+	//while the first one is processed, or while the second one is
+	for(int stage=BooleanStatistics::CONSTRUCT;stage<=BooleanStatistics::CLASSIFY;stage++)
 	{
-		verticesArray[i] = vertices[i].getPosition();
+		long long idle2 = stage==BooleanStatistics::CONSTRUCT ? 0 : statistics2.getCurrentBytes(stage-1);
+		statistics.peakBytes[stage] = std::max(statistics1.peakBytes[stage]+idle2, statistics1.getCurrentBytes(stage)+statistics2.peakBytes[stage]);
 	}
+	
+	int compose = BooleanStatistics::COMPOSE;
+	std::lock_guard<std::mutex> lock(composeFigures.mutex);
+	for(int category=0;category<BooleanStatistics::NUM_MEMORY_CATEGORIES;category++)
+	{
+		statistics.currentBytes[compose][category] = statistics.currentBytes[BooleanStatistics::CLASSIFY][category];
+	}
+	statistics.currentBytes[compose][BooleanStatistics::COMPOSE_BUFFERS] = composeFigures.resultBytes;
+	statistics.peakBytes[compose] = statistics.getCurrentBytes(BooleanStatistics::CLASSIFY)+composeFigures.bytes;
+	statistics.allocations[compose] = composeFigures.allocations;
+	statistics.stageTimes[compose] = composeFigures.time;
+	return statistics;
+}
 
-	//returns the solid containing the grouped elements
-	return Solid(verticesArray, indices, colors);
+/**
+ * Estimates, before any work is done, the most memory a bool operation may hold at
+ * once: both objects after splitting, with reallocation slack and adjacency lists,
+ * plus the composition buffers and the resulting solid. The estimate is meant as an
+ * upper bound for ordinary inputs; heavily coplanar inputs may split more.
+ * 
+ * @param numFaces1 number of faces of the first solid
+ * @param numFaces2 number of faces of the second solid
+ * @return estimated peak bytes
+ */
+long long BooleanModeller::estimatePeakBytes(long long numFaces1, long long numFaces2)
+{
+	long long faces = (numFaces1+numFaces2)*SPLIT_GROWTH;
+	//closed triangle meshes have about half as many vertices as faces
+	long long vertices = faces/2+4;
+	long long vertexBytes = sizeof(Vertex)+ADJACENCY_CAPACITY*sizeof(int);
+	
+	//vectors grow by doubling: up to twice the size
+	long long objects = 2*(faces*sizeof(Face)+vertices*vertexBytes);
+	
+	//composition: welded vertex of each object vertex, welded vertices and their grid,
+	//the buffers of the result with slack, taken over by the result
+	long long compose = vertices*(2*sizeof(int)+sizeof(Point3f)+sizeof(Colour3f)+WELD_CELL_BYTES);
+	compose += 2*(vertices*(sizeof(Point3f)+sizeof(Colour3f))+3*faces*sizeof(int));
+	return objects+compose;
+}
+
+//----------------------------------SETTERS-------------------------------------//
+
+/**
+ * Sets whether the fragments the split left of each input triangle are merged back
+ * and triangulated again in the resulting solids (see FragmentMerger). Merging keeps
+ * the face count of repeated operations proportional to the geometry, at the cost of
+ * a pass over the result.
+ * 
+ * @param merge true to merge the fragments, false (default) to keep them
+ */
+void BooleanModeller::setFragmentMerging(bool merge)
+{
+	fragmentMerging = merge;
 }
 
 /**
-	* Fills solid arrays with data about faces of an object generated whose status
-	* is as required
+ * Sets the needle and tiny triangles removed from the resulting solids by collapsing
+ * their edges (see EdgeCollapser). Collapses keep the topology, never flip a triangle,
+ * and change the volume by maxVolumeChange at most. They run after fragment merging.
+ * 
+ * @param minQuality triangles of lower quality are removed: 0 (default) keeps all, 1 is
+ * an equilateral triangle (see EdgeCollapser::getQuality)
+ * @param minEdgeLength triangles with a shorter edge are removed, 0 keeps all
+ * @param maxVolumeChange most the volume may change, relative to the resulting solid
+ */
+void BooleanModeller::setSliverCollapse(double minQuality, double minEdgeLength, double maxVolumeChange)
+{
+	sliverQuality = minQuality;
+	sliverEdgeLength = minEdgeLength;
+	sliverVolumeChange = maxVolumeChange;
+}
+
+//--------------------------PRIVATES--------------------------------------------//
+
+/**
+ * Copies the figures of a composition, each copy with a lock of its own
+ * 
+ * @param other figures copied
+ */
+BooleanModeller::ComposeFigures::ComposeFigures(const ComposeFigures& other)
+{
+	*this = other;
+}
+
+/**
+ * Copies the figures of a composition, keeping the lock
+ * 
+ * @param other figures copied
+ * @return this figures
+ */
+BooleanModeller::ComposeFigures& BooleanModeller::ComposeFigures::operator=(const ComposeFigures& other)
+{
+	if(this!=&other)
+	{
+		std::scoped_lock lock(mutex, other.mutex);
+		time = other.time;
+		bytes = other.bytes;
+		resultBytes = other.resultBytes;
+		allocations = other.allocations;
+	}
+	return *this;
+}
+
+/**
+	* Composes the solids resulting from bool operations, scanning the faces of both
+	* objects once. Each face goes to every solid whose operation takes its status, and
+	* its vertices are welded by a VertexWelder shared by all of them.
 	*
-	* @param object3d solid object used to fill the arrays
-	* @param vertices vertices array to be filled
-	* @param indices indices array to be filled
-	* @param colors colors array to be filled
-	* @param faceStatus1 a status expected for the faces used to to fill the data arrays
-	* @param faceStatus2 a status expected for the faces used to to fill the data arrays
+	* @param operations mask of UNION, INTERSECTION and DIFFERENCE
+	* @return one solid per operation in the mask, in the order union, intersection, difference
 	*/
-void BooleanModeller::groupObjectComponents(Object3D& object, std::vector<Vertex>& vertices, std::vector<int>& indices, std::vector<Colour3f>& colors, int faceStatus1, int faceStatus2)
+std::vector<Solid> BooleanModeller::composeSolids(int operations) const
 {
-	//for each face..
-	for(int i=0;i<object.getNumFaces();i++)
+	TRACE_SCOPE("BooleanModeller::composeSolids");
+	double start = BooleanStatistics::getTime();
+	long long allocations = 0;
+	auto append = [&allocations](auto& vector, const auto& value)
+	{
+		size_t capacity = vector.capacity();
+		vector.push_back(value);
+		allocations += vector.capacity()!=capacity;
+	};
+
+	std::vector<Composition> compositions;
+	for(int operation : {UNION, INTERSECTION, DIFFERENCE})
 	{
-		const Face& face = object.getFace(i);
-		//if the face status fits with the desired status...
-		if(face.getStatus()==faceStatus1 || face.getStatus()==faceStatus2)
+		if(operations & operation)
 		{
-			//adds the face elements into the arrays
-			std::vector<Vertex> faceVerts = {face.v1(), face.v2(), face.v3()};
-			for(int j=0;j<faceVerts.size();j++)
+			compositions.push_back(Composition());
+			compositions.back().operation = operation;
+		}
+	}
+
+	//welded vertices: the first vertex found equal to each one
+	std::vector<Point3f> weldedVertices;
+	std::vector<Colour3f> weldedColors;
+	VertexWelder welder(weldedVertices, weldedColors);
+
+	//group the elements of the two solids whose faces fit with the desired statuses
+	long long weldedBytes = 0;
+	for(int objectNumber=0;objectNumber<2;objectNumber++)
+	{
+		const Object3D& object = objectNumber==0 ? object1 : object2;
+		int groupOffset = objectNumber==0 ? 0 : numSources1;
+		std::vector<int> weldedOf(object.getNumVertices(), -1);
+		allocations++;
+		weldedBytes = std::max(weldedBytes, (long long)(weldedOf.capacity()*sizeof(int)));
+		for(int i=0;i<object.getNumFaces();i++)
+		{
+			const Face& face = object.getFace(i);
+			for(Composition& composition : compositions)
 			{
-				auto it = std::find_if(vertices.begin(),vertices.end(),
-					[&faceVerts,j](const Vertex& curr_vertex){return curr_vertex.equals(faceVerts[j]);});
-				if(it != vertices.end())
+				int orientation = getFaceOrientation(composition.operation, objectNumber==0, face.getStatus());
+				if(orientation==0)
+				{
+					continue;
+				}
+				if(fragmentMerging)
 				{
-					indices.push_back(it - vertices.begin());
+					append(composition.groups, groupOffset+face.getSource());
 				}
-				else
+				int welded[3];
+				size_t capacity = weldedVertices.capacity();
+				int numCells = welder.getNumCells();
+				welder.weldFace(face, orientation, weldedOf, welded);
+				allocations += 2*(weldedVertices.capacity()!=capacity) + welder.getNumCells()-numCells;
+				if(composition.vertexOf.size()<weldedVertices.size())
 				{
-					indices.push_back(vertices.size());
-					vertices.push_back(faceVerts[j]);
-					colors.push_back(faceVerts[j].getColor());
+					composition.vertexOf.resize(weldedVertices.size(), -1);
+				}
+				for(int corner=0;corner<3;corner++)
+				{
+					int& vertexIndex = composition.vertexOf[welded[corner]];
+					if(vertexIndex<0)
+					{
+						vertexIndex = composition.vertices.size();
+						append(composition.vertices, weldedVertices[welded[corner]]);
+						append(composition.colors, weldedColors[welded[corner]]);
+					}
+					append(composition.indices, vertexIndex);
 				}
 			}
 		}
 	}
+
+	//everything but the results is alive at this point
+	long long bytes = weldedBytes + weldedVertices.capacity()*(sizeof(Point3f)+sizeof(Colour3f)) + welder.getNumCells()*WELD_CELL_BYTES;
+	long long resultBytes = 0;
+	std::vector<Solid> results;
+	for(Composition& composition : compositions)
+	{
+		bytes += composition.vertexOf.capacity()*sizeof(int) + composition.groups.capacity()*sizeof(int);
+
+		//merges the fragments of each input triangle
+		if(fragmentMerging)
+		{
+			FragmentMerger::merge(composition.vertices, composition.indices, composition.colors, composition.groups);
+		}
+
+		//removes the slivers
+		if(sliverQuality>0 || sliverEdgeLength>0)
+		{
+			EdgeCollapser::collapse(composition.vertices, composition.indices, composition.colors, sliverQuality, sliverEdgeLength, sliverVolumeChange);
+		}
+
+		//the solid takes over the buffers
+		results.push_back(Solid());
+		results.back().setData(std::move(composition.vertices), std::move(composition.indices), std::move(composition.colors));
+		resultBytes += getSolidBytes(results.back());
+	}
+
+	std::lock_guard<std::mutex> lock(composeFigures.mutex);
+	composeFigures.bytes = bytes+resultBytes;
+	composeFigures.resultBytes = resultBytes;
+	composeFigures.allocations = allocations;
+	composeFigures.time = BooleanStatistics::getTime()-start;
+	return results;
+}
+
+/**
+	* Gets the bytes allocated by a solid
+	*
+	* @param solid solid to measure
+	* @return allocated bytes
+	*/
+long long BooleanModeller::getSolidBytes(const Solid& solid)
+{
+	return solid.getVertices().capacity()*sizeof(Point3f) + solid.getIndices().capacity()*sizeof(int) + solid.getColors().capacity()*sizeof(Colour3f);
 }
@@ -1,10 +1,13 @@
 #ifndef __BOOLEAN_MODELLER__
 #define __BOOLEAN_MODELLER__
 
+#include <mutex>
 #include <vector>
 #include "Point3f.hpp"
 #include "Object3D.hpp"
 #include "Solid.hpp"
+#include "BooleanStatistics.hpp"
+#include "MassProperties.hpp"
 
 
 /**
@@ -13,6 +16,10 @@
  * <br><br>Two 'Solid' objects are submitted to this class constructor. There is a methods for 
  * each bool operation. Each of these return a 'Solid' resulting from the application
  * of its operation into the submitted solids. 
+ * 
+ * <br><br>The solids are split and classified by the constructor. The results are then
+ * composed without modifying the modeller, so several threads may get results from
+ * the same modeller at once, as long as none of them calls a setter.
  *  
  * <br><br>See: D. H. Laidlaw, W. B. Trumbore, and J. F. Hughes.  
  * "Constructive Solid Geometry for Polyhedral Objects" 
@@ -24,25 +31,116 @@
 class BooleanModeller
 {
 public:
+	/** faces are classified tracing a ray from their baricenter (see Face::rayTraceClassify) */
+	static const int RAY_TRACE = 1;
+	/** faces are classified by the fast winding number of the other solid (see Face::windingNumberClassify) */
+	static const int WINDING_NUMBER = 2;
+	/** faces are split by each crossing face in turn, and the pieces tested again (see Object3D::splitFaces) */
+	static const int INCREMENTAL_SPLIT = 1;
+	/** faces gather all their crossing segments and are triangulated once, in parallel (see Object3D::splitFacesBatched) */
+	static const int BATCHED_SPLIT = 2;
+	/** bool operation: union (operations can be combined as a mask, see getSolids) */
+	static const int UNION = 1;
+	/** bool operation: intersection */
+	static const int INTERSECTION = 2;
+	/** bool operation: difference, the second solid substracted from the first */
+	static const int DIFFERENCE = 4;
+
 	//--------------------------------CONSTRUCTORS----------------------------------//
 	
-	BooleanModeller(const Solid& solid1, const Solid& solid2);
+	BooleanModeller(const Solid& solid1, const Solid& solid2, int classification = RAY_TRACE, int splitting = INCREMENTAL_SPLIT);
 				
 	//-------------------------------BOOLEAN_OPERATIONS-----------------------------//
 	
-	Solid getUnion();
+	Solid getUnion() const;
+	
+	Solid getIntersection() const;
+	
+	Solid getDifference() const;
+	
+	std::vector<Solid> getSolids(int operations) const;
+	
+	//------------------------------------QUERIES-----------------------------------//
+	
+	static bool interfere(const Solid& solid1, const Solid& solid2);
+	
+	MassProperties getMassProperties(int operation) const;
+	
+	static int getFaceOrientation(int operation, bool firstObject, int faceStatus);
+	
+	//---------------------------------STATISTICS-----------------------------------//
 	
-	Solid getIntersection();
+	BooleanStatistics getStatistics() const;
 	
-	Solid getDifference();
+	static long long estimatePeakBytes(long long numFaces1, long long numFaces2);
+	
+	//----------------------------------SETTERS-------------------------------------//
+	
+	void setFragmentMerging(bool merge);
+	
+	void setSliverCollapse(double minQuality, double minEdgeLength = 0, double maxVolumeChange = 1e-6);
 	
 private:
 
-	Solid composeSolid(int faceStatus1, int faceStatus2, int faceStatus3);
-	
-	void groupObjectComponents(Object3D& object, std::vector<Vertex>& vertices, std::vector<int>& indices, std::vector<Colour3f>& colors, int faceStatus1, int faceStatus2);
+	/** buffers of a resulting solid while it is composed */
+	struct Composition
+	{
+		/** operation the solid results from */
+		int operation;
+		/** position of each welded vertex on the solid vertices, -1 if not used yet */
+		std::vector<int> vertexOf;
+		/** solid vertices */
+		std::vector<Point3f> vertices;
+		/** solid vertex colors */
+		std::vector<Colour3f> colors;
+		/** solid triangles */
+		std::vector<int> indices;
+		/** input triangle of each solid triangle (only if fragments are merged) */
+		std::vector<int> groups;
+	};
+
+	/** figures of the last composition, guarded as results may be composed concurrently; copies take the figures but not the lock */
+	struct ComposeFigures
+	{
+		ComposeFigures() = default;
+		ComposeFigures(const ComposeFigures& other);
+		ComposeFigures& operator=(const ComposeFigures& other);
+
+		mutable std::mutex mutex;
+		/** time spent, in seconds */
+		double time = 0;
+		/** bytes held at once by the buffers */
+		long long bytes = 0;
+		/** bytes held by the resulting solids */
+		long long resultBytes = 0;
+		/** allocations made */
+		long long allocations = 0;
+	};
+
+	std::vector<Solid> composeSolids(int operations) const;
+
+	static long long getSolidBytes(const Solid& solid);
 
 	/** solid where bool operations will be applied */
 	Object3D object1, object2;
+	/** number of triangles of the first solid, so that the faces of both solids get distinct groups */
+	int numSources1;
+	/** true if the fragments of each input triangle are merged in the resulting solids */
+	bool fragmentMerging = false;
+	/** triangles of lower quality are collapsed in the resulting solids (see EdgeCollapser) */
+	double sliverQuality = 0;
+	/** triangles with a shorter edge are collapsed in the resulting solids */
+	double sliverEdgeLength = 0;
+	/** most the collapses may change the volume of a resulting solid, relative to it */
+	double sliverVolumeChange = 0;
+	/** figures of the last composition */
+	mutable ComposeFigures composeFigures;
+
+	/** bytes of a cell of the welding grid holding one vertex, used by estimatePeakBytes */
+	static const int WELD_CELL_BYTES = 96;
+	/** expected ratio of faces after splitting to faces before, used by estimatePeakBytes */
+	static const int SPLIT_GROWTH = 3;
+	/** expected adjacency list capacity of a vertex, used by estimatePeakBytes */
+	static const int ADJACENCY_CAPACITY = 8;
 };
 #endif //__BOOLEAN_MODELLER__
\ No newline at end of file
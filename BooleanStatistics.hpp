@@ -0,0 +1,187 @@
+#ifndef __BOOLEAN_STATISTICS__
+#define __BOOLEAN_STATISTICS__
+
+#include<chrono>
+
+/**
+ * Counters and stage times collected while a bool operation is computed.
+ *
+ * <br><br>Each Object3D counts the work done on its own faces; BooleanModeller adds
+ * the counters of both objects together with the composition time. Counting is a
+ * plain increment in the serial loops, so it is always on.
+ *
+ * @author akatsia-games on github.com
+ */
+class BooleanStatistics
+{
+public:
+	/** stage: construction of the objects from the solids */
+	static const int CONSTRUCT = 0;
+	/** stage: face splitting (see Object3D::splitFaces) */
+	static const int SPLIT = 1;
+	/** stage: face classification (see Object3D::classifyFaces) */
+	static const int CLASSIFY = 2;
+	/** stage: composition of the resulting solid */
+	static const int COMPOSE = 3;
+	/** number of stages */
+	static const int NUM_STAGES = 4;
+
+	/** split case: VERTEX-EDGE-EDGE / EDGE-EDGE-VERTEX (breakFaceInTwo by edge) */
+	static const int BREAK_IN_TWO_EDGE = 0;
+	/** split case: VERTEX-FACE-EDGE / EDGE-FACE-VERTEX (breakFaceInTwo by vertex) */
+	static const int BREAK_IN_TWO_VERTEX = 1;
+	/** split case: EDGE-EDGE-EDGE (breakFaceInThree by edge) */
+	static const int BREAK_IN_THREE_EDGE = 2;
+	/** split case: VERTEX-FACE-FACE / FACE-FACE-VERTEX (breakFaceInThree by vertex) */
+	static const int BREAK_IN_THREE_VERTEX = 3;
+	/** split case: EDGE-FACE-EDGE (breakFaceInThree by two vertices) */
+	static const int BREAK_IN_THREE_EDGES = 4;
+	/** split case: FACE-FACE-FACE reduced to a point (breakFaceInThree by point) */
+	static const int BREAK_IN_THREE_POINT = 5;
+	/** split case: EDGE-FACE-FACE / FACE-FACE-EDGE (breakFaceInFour) */
+	static const int BREAK_IN_FOUR = 6;
+	/** split case: FACE-FACE-FACE (breakFaceInFive) */
+	static const int BREAK_IN_FIVE = 7;
+	/** number of split cases */
+	static const int NUM_SPLIT_CASES = 8;
+
+	/** memory: Object3D vertices */
+	static const int VERTICES = 0;
+	/** memory: Object3D faces */
+	static const int FACES = 1;
+	/** memory: vertex adjacency lists */
+	static const int ADJACENCY = 2;
+	/** memory: intersection segments, held on the stack while splitting */
+	static const int SEGMENTS = 3;
+	/** memory: spatial index of the other object (winding number classification only) */
+	static const int SPATIAL_INDEX = 4;
+	/** memory: buffers of the composition and the resulting solid */
+	static const int COMPOSE_BUFFERS = 5;
+	/** number of memory categories */
+	static const int NUM_MEMORY_CATEGORIES = 6;
+
+	/** faces whose bound didn't overlap the other object bound, so none of their pairs was tested */
+	long long facesRejected = 0;
+	/** face pairs whose bounds were compared */
+	long long pairsTested = 0;
+	/** face pairs rejected because their bounds don't overlap */
+	long long pairsRejected = 0;
+	/** face pairs whose intersection segments overlap */
+	long long segmentIntersections = 0;
+	/** faces broken, by split case */
+	long long splits[NUM_SPLIT_CASES] = {};
+	/** faces before splitting */
+	long long facesBeforeSplit = 0;
+	/** faces after splitting */
+	long long facesAfterSplit = 0;
+	/** faces triangulated again with all their segments at once (see Object3D::splitFacesBatched) */
+	long long facesRetriangulated = 0;
+	/** faces classified from the status of their vertices (see Face::simpleClassify) */
+	long long simpleClassified = 0;
+	/** faces classified by ray tracing (see Face::rayTraceClassify) */
+	long long rayTraceClassified = 0;
+	/** faces classified by winding number (see Face::windingNumberClassify) */
+	long long windingNumberClassified = 0;
+	/** rays traced again after their direction was perturbed */
+	long long perturbRetries = 0;
+	/** time per stage in seconds */
+	double stageTimes[NUM_STAGES] = {};
+	/** bytes held at the end of each stage, by category */
+	long long currentBytes[NUM_STAGES][NUM_MEMORY_CATEGORIES] = {};
+	/** most bytes held at once during each stage */
+	long long peakBytes[NUM_STAGES] = {};
+	/** heap allocations (including reallocations) made during each stage */
+	long long allocations[NUM_STAGES] = {};
+
+	/**
+	 * Gets the number of faces broken in all split cases
+	 *
+	 * @return number of faces broken
+	 */
+	long long getNumSplits() const
+	{
+		long long sum = 0;
+		for(int i=0;i<NUM_SPLIT_CASES;i++)
+		{
+			sum += splits[i];
+		}
+		return sum;
+	}
+
+	/**
+	 * Gets the bytes held at the end of a stage
+	 *
+	 * @param stage CONSTRUCT, SPLIT, CLASSIFY or COMPOSE
+	 * @return bytes held in all categories
+	 */
+	long long getCurrentBytes(int stage) const
+	{
+		long long sum = 0;
+		for(int i=0;i<NUM_MEMORY_CATEGORIES;i++)
+		{
+			sum += currentBytes[stage][i];
+		}
+		return sum;
+	}
+
+	/**
+	 * Gets the most bytes held at once during the whole operation
+	 *
+	 * @return peak bytes
+	 */
+	long long getPeakBytes() const
+	{
+		long long peak = 0;
+		for(int i=0;i<NUM_STAGES;i++)
+		{
+			peak = peak>peakBytes[i] ? peak : peakBytes[i];
+		}
+		return peak;
+	}
+
+	/**
+	 * Adds the counters and times of other statistics to these. Memory held at the end
+	 * of each stage is added too, as is the peak, which assumes both peaks coincide.
+	 *
+	 * @param other statistics to add
+	 */
+	void add(const BooleanStatistics& other)
+	{
+		facesRejected += other.facesRejected;
+		pairsTested += other.pairsTested;
+		pairsRejected += other.pairsRejected;
+		segmentIntersections += other.segmentIntersections;
+		for(int i=0;i<NUM_SPLIT_CASES;i++)
+		{
+			splits[i] += other.splits[i];
+		}
+		facesBeforeSplit += other.facesBeforeSplit;
+		facesAfterSplit += other.facesAfterSplit;
+		facesRetriangulated += other.facesRetriangulated;
+		simpleClassified += other.simpleClassified;
+		rayTraceClassified += other.rayTraceClassified;
+		windingNumberClassified += other.windingNumberClassified;
+		perturbRetries += other.perturbRetries;
+		for(int i=0;i<NUM_STAGES;i++)
+		{
+			stageTimes[i] += other.stageTimes[i];
+			for(int j=0;j<NUM_MEMORY_CATEGORIES;j++)
+			{
+				currentBytes[i][j] += other.currentBytes[i][j];
+			}
+			peakBytes[i] += other.peakBytes[i];
+			allocations[i] += other.allocations[i];
+		}
+	}
+
+	/**
+	 * Gets a monotonic time stamp, used to measure the stages
+	 *
+	 * @return time in seconds from an arbitrary origin
+	 */
+	static double getTime()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+};
+#endif //__BOOLEAN_STATISTICS__
@@ -82,6 +82,26 @@ Bound::Bound(const Bound& other)
 	zMin = other.zMin;
 }
 
+/**
+ * Bound constructor enclosing two other bounds
+ * 
+ * @param first one of the bounds to be enclosed
+ * @param second one of the bounds to be enclosed
+ */
+Bound::Bound(const Bound& first, const Bound& second)
+	:Bound(first)
+{
+	if(std::isnan(xMin))
+	{
+		*this = second;
+	}
+	else if(!std::isnan(second.xMin))
+	{
+		checkVertex(second.getMin());
+		checkVertex(second.getMax());
+	}
+}
+
 //----------------------------------OVERRIDES-----------------------------------//
 
 /**
@@ -134,6 +154,37 @@ bool Bound::overlap(const Bound& bound) const
 	}
 }
 
+/**
+ * Checks if a point is inside the bound
+ * 
+ * @param point point to be tested
+ * @return true if it is inside (or on the border), false otherwise
+ */
+bool Bound::contains(const Point3f& point) const
+{
+	return point.x>=xMin-TOL && point.x<=xMax+TOL && point.y>=yMin-TOL && point.y<=yMax+TOL && point.z>=zMin-TOL && point.z<=zMax+TOL;
+}
+
+/**
+ * Gets the corner with the minimum coordinates
+ * 
+ * @return the minimum corner
+ */
+Point3f Bound::getMin() const
+{
+	return {xMin, yMin, zMin};
+}
+
+/**
+ * Gets the corner with the maximum coordinates
+ * 
+ * @return the maximum corner
+ */
+Point3f Bound::getMax() const
+{
+	return {xMax, yMax, zMax};
+}
+
 //-------------------------------------PRIVATES---------------------------------//
 
 /**
@@ -46,6 +46,16 @@ public:
 	 */
 	Bound(const Bound& other);
 	
+	Bound& operator=(const Bound& other) = default;
+	
+	/**
+	 * Bound constructor enclosing two other bounds
+	 * 
+	 * @param first one of the bounds to be enclosed
+	 * @param second one of the bounds to be enclosed
+	 */
+	Bound(const Bound& first, const Bound& second);
+	
 	//----------------------------------OVERRIDES-----------------------------------//
 	
 	/**
@@ -67,6 +77,28 @@ public:
 	 */
 	bool overlap(const Bound& bound) const;
 	
+	/**
+	 * Checks if a point is inside the bound
+	 * 
+	 * @param point point to be tested
+	 * @return true if it is inside (or on the border), false otherwise
+	 */
+	bool contains(const Point3f& point) const;
+	
+	/**
+	 * Gets the corner with the minimum coordinates
+	 * 
+	 * @return the minimum corner
+	 */
+	Point3f getMin() const;
+	
+	/**
+	 * Gets the corner with the maximum coordinates
+	 * 
+	 * @return the maximum corner
+	 */
+	Point3f getMax() const;
+	
 	//-------------------------------------PRIVATES---------------------------------//
 	
 
@@ -0,0 +1,239 @@
+#include "CoordinateFile.hpp"
+#include "MappedFile.hpp"
+#include "Parallel.hpp"
+#include "Solid.hpp"
+#include "Trace.hpp"
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <vector>
+
+/**
+ * Fast loader for the coordinates file format read by Solid(std::basic_istream&, Colour3f).
+ * 
+ * @author akatsia-games on github.com
+ */
+
+//---------------------------------------LOAD-----------------------------------//
+
+/**
+ * Loads a coordinates file into a solid
+ * 
+ * @param path file path
+ * @param solid solid receiving the data
+ * @param color solid color
+ * @return true if the file was read, false if it couldn't be opened or is malformed
+ */
+bool CoordinateFile::load(const std::string& path, Solid& solid, Colour3f color)
+{
+	TRACE_SCOPE("CoordinateFile::load");
+	MappedFile file(path);
+	if(!file.isOpen())
+	{
+		return false;
+	}
+	return parse(file.getData(), file.getData()+file.getSize(), solid, color);
+}
+
+/**
+ * Parses the contents of a coordinates file into a solid
+ * 
+ * @param begin first character of the file
+ * @param end one past the last character of the file
+ * @param solid solid receiving the data, left untouched if the contents are malformed
+ * @param color solid color
+ * @return true if the contents were read, false if they are malformed
+ */
+bool CoordinateFile::parse(const char* begin, const char* end, Solid& solid, Colour3f color)
+{
+	TRACE_SCOPE("CoordinateFile::parse");
+	const char* position = skipSpaces(begin, end);
+	int numVertices;
+	if(!parseToken(position, end, numVertices) || numVertices<0)
+	{
+		return false;
+	}
+	long long numCoordinates = 3LL*numVertices;
+	
+	//split the rest of the file in chunks starting at white space
+	int numChunks = 1;
+	if((size_t)(end-position)>PARALLEL_SIZE)
+	{
+		numChunks = Parallel::getNumThreads()*CHUNKS_PER_THREAD;
+	}
+	std::vector<const char*> bounds(numChunks+1);
+	bounds[0] = position;
+	bounds[numChunks] = end;
+	for(int i=1;i<numChunks;i++)
+	{
+		const char* bound = position + (end-position)*(long long)i/numChunks;
+		bounds[i] = skipToken(std::max(bound, bounds[i-1]), end);
+	}
+	
+	//count the tokens of each chunk to know the index of its first token
+	std::vector<long long> firstToken(numChunks+1, 0);
+	Parallel::forEach(0, numChunks, [&bounds, &firstToken, end](int chunk)
+	{
+		long long count = 0;
+		for(const char* current = skipSpaces(bounds[chunk], bounds[chunk+1]); current<bounds[chunk+1]; current = skipSpaces(skipToken(current, end), bounds[chunk+1]))
+		{
+			count++;
+		}
+		firstToken[chunk+1] = count;
+	}, 1);
+	for(int i=0;i<numChunks;i++)
+	{
+		firstToken[i+1] += firstToken[i];
+	}
+	
+	//the number of triangles follows the coordinates
+	if(firstToken[numChunks]<=numCoordinates)
+	{
+		return false;
+	}
+	int numTriangles = -1;
+	for(int chunk=0;chunk<numChunks;chunk++)
+	{
+		if(firstToken[chunk+1]>numCoordinates)
+		{
+			const char* current = skipSpaces(bounds[chunk], end);
+			for(long long token=firstToken[chunk];token<numCoordinates;token++)
+			{
+				current = skipSpaces(skipToken(current, end), end);
+			}
+			if(!parseToken(current, end, numTriangles))
+			{
+				return false;
+			}
+			break;
+		}
+	}
+	long long numIndices = 3LL*numTriangles;
+	if(numTriangles<0 || firstToken[numChunks]<numCoordinates+1+numIndices)
+	{
+		return false;
+	}
+	
+	std::vector<Point3f> vertices(numVertices);
+	std::vector<int> indices(numIndices);
+	std::atomic<bool> valid(true);
+	Parallel::forEach(0, numChunks, [&](int chunk)
+	{
+		const char* current = skipSpaces(bounds[chunk], bounds[chunk+1]);
+		for(long long token=firstToken[chunk];token<firstToken[chunk+1];token++)
+		{
+			bool parsed = true;
+			if(token<numCoordinates)
+			{
+				Point3f& vertex = vertices[token/3];
+				double& coordinate = (token%3==0) ? vertex.x : ((token%3==1) ? vertex.y : vertex.z);
+				parsed = parseToken(current, end, coordinate);
+			}
+			else if(token>numCoordinates && token<=numCoordinates+numIndices)
+			{
+				parsed = parseToken(current, end, indices[token-numCoordinates-1]);
+			}
+			else
+			{
+				current = skipToken(current, end);
+			}
+			
+			if(!parsed)
+			{
+				valid = false;
+				return;
+			}
+			current = skipSpaces(current, bounds[chunk+1]);
+		}
+	}, 1);
+	if(!valid)
+	{
+		return false;
+	}
+	
+	std::vector<Colour3f> colors(numVertices, color);
+	solid.setData(std::move(vertices), std::move(indices), std::move(colors));
+	return true;
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/**
+ * Skips white space
+ * 
+ * @param position current character
+ * @param end limit of the search
+ * @return first character that isn't white space, or end
+ */
+const char* CoordinateFile::skipSpaces(const char* position, const char* end)
+{
+	while(position<end && (*position==' ' || (*position>='\t' && *position<='\r')))
+	{
+		position++;
+	}
+	return position;
+}
+
+/**
+ * Skips the rest of a token
+ * 
+ * @param position current character
+ * @param end limit of the search
+ * @return first white space character after position, or end
+ */
+const char* CoordinateFile::skipToken(const char* position, const char* end)
+{
+	while(position<end && !(*position==' ' || (*position>='\t' && *position<='\r')))
+	{
+		position++;
+	}
+	return position;
+}
+
+/**
+ * Parses a floating point token, moving the position to its end
+ * 
+ * @param position first character of the token
+ * @param end end of the file
+ * @param value parsed value
+ * @return true if the whole token is a finite number, false otherwise
+ */
+bool CoordinateFile::parseToken(const char*& position, const char* end, double& value)
+{
+	//from_chars doesn't accept the explicit plus sign accepted by streams
+	if(position<end && *position=='+')
+	{
+		position++;
+	}
+	//from_chars accepts nan and infinities, which streams reject
+	std::from_chars_result result = std::from_chars(position, end, value);
+	if(result.ec!=std::errc() || skipToken(result.ptr, end)!=result.ptr || !std::isfinite(value))
+	{
+		return false;
+	}
+	position = result.ptr;
+	return true;
+}
+
+/**
+ * Parses an integer token, moving the position to its end
+ * 
+ * @param position first character of the token
+ * @param end end of the file
+ * @param value parsed value
+ * @return true if the whole token is an integer, false otherwise
+ */
+bool CoordinateFile::parseToken(const char*& position, const char* end, int& value)
+{
+	if(position<end && *position=='+')
+	{
+		position++;
+	}
+	std::from_chars_result result = std::from_chars(position, end, value);
+	if(result.ec!=std::errc() || skipToken(result.ptr, end)!=result.ptr)
+	{
+		return false;
+	}
+	position = result.ptr;
+	return true;
+}
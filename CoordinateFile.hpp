@@ -0,0 +1,42 @@
+#ifndef __COORDINATE_FILE__
+#define __COORDINATE_FILE__
+
+#include<string>
+#include"Point3f.hpp"
+
+class Solid;
+
+/**
+ * Fast loader for the coordinates file format read by Solid(std::basic_istream&, Colour3f):
+ * the number of vertices, the vertex coordinates, the number of triangles and the 
+ * vertex indices, all separated by white space.
+ * 
+ * <br><br>The file is mapped in memory and the numbers are read with std::from_chars.
+ * Big files are split in chunks at white space boundaries: the tokens of each chunk are 
+ * counted in parallel, which tells where every chunk starts in the token sequence, and
+ * then the chunks are parsed in parallel straight into the solid arrays.
+ * 
+ * @author akatsia-games on github.com
+ */
+class CoordinateFile
+{
+public:
+	static bool load(const std::string& path, Solid& solid, Colour3f color);
+
+	static bool parse(const char* begin, const char* end, Solid& solid, Colour3f color);
+
+private:
+	static const char* skipSpaces(const char* position, const char* end);
+
+	static const char* skipToken(const char* position, const char* end);
+
+	static bool parseToken(const char*& position, const char* end, double& value);
+
+	static bool parseToken(const char*& position, const char* end, int& value);
+
+	/** files smaller than this are parsed by a single thread */
+	static const size_t PARALLEL_SIZE = 1<<20;
+	/** number of chunks given to each thread */
+	static const int CHUNKS_PER_THREAD = 4;
+};
+#endif //__COORDINATE_FILE__
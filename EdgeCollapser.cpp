@@ -0,0 +1,464 @@
+#include "EdgeCollapser.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <queue>
+
+/**
+ * Removes needle and tiny triangles from a solid by collapsing their edges.
+ *
+ * @author akatsia-games on github.com
+ */
+
+/**
+ * Collapses the edges of the bad triangles of a solid, after splitting the triangles
+ * at its T-junctions. Vertices no longer used are removed.
+ *
+ * @param vertices solid vertices, compacted on return
+ * @param indices solid triangles (three indices each), replaced on return
+ * @param colors vertex colors, compacted with the vertices
+ * @param minQuality triangles of lower quality are removed (0 to keep all, 1 for equilateral only)
+ * @param minEdgeLength triangles with a shorter edge are removed (0 to keep all)
+ * @param maxVolumeChange most the volume may change, relative to the solid volume
+ * @return number of triangles removed, net of the ones the splits add
+ */
+int EdgeCollapser::collapse(std::vector<Point3f>& vertices, std::vector<int>& indices, std::vector<Colour3f>& colors, double minQuality, double minEdgeLength, double maxVolumeChange)
+{
+	TRACE_SCOPE("EdgeCollapser::collapse");
+	int numInput = indices.size()/3;
+	splitJunctions(vertices, indices);
+	int numTriangles = indices.size()/3;
+
+	//triangles around each vertex, and the volume budget
+	std::vector<std::vector<int>> stars(vertices.size());
+	double volume = 0;
+	for(int i=0;i<numTriangles;i++)
+	{
+		const Point3f& p1 = vertices[indices[3*i]];
+		const Point3f& p2 = vertices[indices[3*i+1]];
+		const Point3f& p3 = vertices[indices[3*i+2]];
+		volume += p1.x*(p2.y*p3.z-p2.z*p3.y)+p1.y*(p2.z*p3.x-p2.x*p3.z)+p1.z*(p2.x*p3.y-p2.y*p3.x);
+		for(int corner=0;corner<3;corner++)
+		{
+			stars[indices[3*i+corner]].push_back(i);
+		}
+	}
+	double budget = maxVolumeChange*std::abs(volume)/6;
+
+	std::vector<char> alive(numTriangles, 1);
+	auto isBad = [&](int triangle)
+	{
+		return getShortestEdge(vertices, indices, triangle)<minEdgeLength ||
+			getQuality(vertices[indices[3*triangle]], vertices[indices[3*triangle+1]], vertices[indices[3*triangle+2]])<minQuality;
+	};
+
+	//bad triangles, the shortest edges first
+	typedef std::pair<double,int> Entry;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+	for(int i=0;i<numTriangles;i++)
+	{
+		if(isBad(i))
+		{
+			queue.push({getShortestEdge(vertices, indices, i), i});
+		}
+	}
+
+	while(!queue.empty())
+	{
+		int triangle = queue.top().second;
+		queue.pop();
+		if(!alive[triangle] || !isBad(triangle))
+		{
+			continue;
+		}
+
+		//edges from the shortest
+		std::pair<double,int> edges[3];
+		for(int corner=0;corner<3;corner++)
+		{
+			const Point3f& start = vertices[indices[3*triangle+corner]];
+			const Point3f& end = vertices[indices[3*triangle+(corner+1)%3]];
+			edges[corner] = {start.distance(end), corner};
+		}
+		std::sort(edges, edges+3);
+
+		for(const std::pair<double,int>& edge : edges)
+		{
+			int start = indices[3*triangle+edge.second];
+			int end = indices[3*triangle+(edge.second+1)%3];
+			double change1 = getCollapseChange(vertices, indices, stars, start, end);
+			double change2 = getCollapseChange(vertices, indices, stars, end, start);
+			bool valid1 = !std::isnan(change1) && std::abs(change1)<=budget;
+			bool valid2 = !std::isnan(change2) && std::abs(change2)<=budget;
+			if(!valid1 && !valid2)
+			{
+				continue;
+			}
+
+			bool forward = valid1 && (!valid2 || std::abs(change1)<=std::abs(change2));
+			int from = forward ? start : end;
+			int to = forward ? end : start;
+			budget -= std::abs(forward ? change1 : change2);
+			applyCollapse(indices, stars, alive, from, to);
+
+			for(int other : stars[to])
+			{
+				if(isBad(other))
+				{
+					queue.push({getShortestEdge(vertices, indices, other), other});
+				}
+			}
+			break;
+		}
+	}
+
+	//remove the dead triangles and the vertices left unused
+	std::vector<int> remap(vertices.size(), -1);
+	std::vector<int> newIndices;
+	std::vector<Point3f> newVertices;
+	std::vector<Colour3f> newColors;
+	newIndices.reserve(indices.size());
+	for(int i=0;i<numTriangles;i++)
+	{
+		if(!alive[i])
+		{
+			continue;
+		}
+		for(int corner=0;corner<3;corner++)
+		{
+			int index = indices[3*i+corner];
+			if(remap[index]<0)
+			{
+				remap[index] = newVertices.size();
+				newVertices.push_back(vertices[index]);
+				newColors.push_back(colors[index]);
+			}
+			newIndices.push_back(remap[index]);
+		}
+	}
+	vertices.swap(newVertices);
+	colors.swap(newColors);
+	indices.swap(newIndices);
+	return numInput-(int)indices.size()/3;
+}
+
+/**
+ * Gets the quality of a triangle: 4*sqrt(3)*area over the sum of its squared edges
+ *
+ * @return 1 for an equilateral triangle, going to 0 as it degenerates
+ */
+double EdgeCollapser::getQuality(const Point3f& p1, const Point3f& p2, const Point3f& p3)
+{
+	Vector3f edge1 = {p2.x-p1.x, p2.y-p1.y, p2.z-p1.z};
+	Vector3f edge2 = {p3.x-p1.x, p3.y-p1.y, p3.z-p1.z};
+	Vector3f edge3 = {p3.x-p2.x, p3.y-p2.y, p3.z-p2.z};
+	double squares = edge1.dot(edge1)+edge2.dot(edge2)+edge3.dot(edge3);
+	if(squares==0)
+	{
+		return 0;
+	}
+	Vector3f cross;
+	cross.cross(edge1, edge2);
+	return 2*std::sqrt(3.0)*cross.length()/squares;
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/**
+ * Splits the triangles at the vertices lying inside their open edges (T-junctions,
+ * left by the composition along the intersection curves, where the needles are), so
+ * that the edges there are shared by two triangles and can be collapsed
+ *
+ * @param vertices solid vertices
+ * @param indices solid triangles, the split ones replaced by their parts
+ */
+void EdgeCollapser::splitJunctions(const std::vector<Point3f>& vertices, std::vector<int>& indices)
+{
+	int numTriangles = indices.size()/3;
+	std::map<std::pair<int,int>,int> edges;
+	for(int i=0;i<numTriangles;i++)
+	{
+		for(int corner=0;corner<3;corner++)
+		{
+			edges[{indices[3*i+corner], indices[3*i+(corner+1)%3]}]++;
+		}
+	}
+
+	//edges without an opposite one, and their ends sorted by x
+	std::vector<int> open;
+	std::vector<std::pair<double,int>> ends;
+	for(int i=0;i<numTriangles;i++)
+	{
+		for(int corner=0;corner<3;corner++)
+		{
+			int start = indices[3*i+corner];
+			int end = indices[3*i+(corner+1)%3];
+			if(edges.count({end, start})==0)
+			{
+				open.push_back(3*i+corner);
+				ends.push_back({vertices[start].x, start});
+				ends.push_back({vertices[end].x, end});
+			}
+		}
+	}
+	if(open.empty())
+	{
+		return;
+	}
+	std::sort(ends.begin(), ends.end());
+	ends.erase(std::unique(ends.begin(), ends.end()), ends.end());
+
+	//vertices inside each open edge, ordered from its start
+	std::map<int, std::vector<std::pair<double,int>>> inner;
+	for(int edge : open)
+	{
+		int start = indices[edge];
+		int end = indices[edge-edge%3+(edge+1)%3];
+		const Point3f& p = vertices[start];
+		const Point3f& q = vertices[end];
+		Vector3f direction = {q.x-p.x, q.y-p.y, q.z-p.z};
+		double lengthSquared = direction.dot(direction);
+		if(lengthSquared==0)
+		{
+			continue;
+		}
+		auto it = std::lower_bound(ends.begin(), ends.end(), std::make_pair(std::min(p.x, q.x)-JUNCTION_TOL, -1));
+		for(;it!=ends.end() && it->first<=std::max(p.x, q.x)+JUNCTION_TOL;it++)
+		{
+			int vertex = it->second;
+			const Point3f& w = vertices[vertex];
+			Vector3f offset = {w.x-p.x, w.y-p.y, w.z-p.z};
+			double t = offset.dot(direction)/lengthSquared;
+			if(vertex==start || vertex==end || t<=0 || t>=1)
+			{
+				continue;
+			}
+			Vector3f distance = {offset.x-t*direction.x, offset.y-t*direction.y, offset.z-t*direction.z};
+			if(distance.dot(distance)<=JUNCTION_TOL*JUNCTION_TOL)
+			{
+				inner[edge].push_back({t, vertex});
+			}
+		}
+	}
+	if(inner.empty())
+	{
+		return;
+	}
+
+	std::vector<int> newIndices;
+	newIndices.reserve(indices.size()+6*inner.size());
+	for(int i=0;i<numTriangles;i++)
+	{
+		int corners[3] = {indices[3*i], indices[3*i+1], indices[3*i+2]};
+		std::vector<int> edgeVertices[3];
+		for(int corner=0;corner<3;corner++)
+		{
+			auto found = inner.find(3*i+corner);
+			if(found!=inner.end())
+			{
+				std::sort(found->second.begin(), found->second.end());
+				for(const std::pair<double,int>& vertex : found->second)
+				{
+					edgeVertices[corner].push_back(vertex.second);
+				}
+			}
+		}
+		splitTriangle(corners, edgeVertices, newIndices);
+	}
+	indices.swap(newIndices);
+}
+
+/**
+ * Splits a triangle at the vertices inside its edges, halving the edge holding the
+ * most of them at each step
+ *
+ * @param corners triangle corners
+ * @param edgeVertices vertices inside each edge, from the corner starting it
+ * @param output triangles the parts are appended to
+ */
+void EdgeCollapser::splitTriangle(const int corners[3], const std::vector<int> edgeVertices[3], std::vector<int>& output)
+{
+	int edge = 0;
+	for(int corner=1;corner<3;corner++)
+	{
+		if(edgeVertices[corner].size()>edgeVertices[edge].size())
+		{
+			edge = corner;
+		}
+	}
+	const std::vector<int>& split = edgeVertices[edge];
+	if(split.empty())
+	{
+		output.insert(output.end(), corners, corners+3);
+		return;
+	}
+
+	//the triangle a b c, split on ab at p into a p c and p b c
+	int a = corners[edge];
+	int b = corners[(edge+1)%3];
+	int c = corners[(edge+2)%3];
+	size_t middle = split.size()/2;
+	int p = split[middle];
+	int first[3] = {a, p, c};
+	std::vector<int> firstVertices[3] = {std::vector<int>(split.begin(), split.begin()+middle), {}, edgeVertices[(edge+2)%3]};
+	splitTriangle(first, firstVertices, output);
+	int second[3] = {p, b, c};
+	std::vector<int> secondVertices[3] = {std::vector<int>(split.begin()+middle+1, split.end()), edgeVertices[(edge+1)%3], {}};
+	splitTriangle(second, secondVertices, output);
+}
+
+/**
+ * Gets the volume change of moving a vertex onto a neighbour, checking the collapse
+ * keeps the topology and doesn't flip any triangle
+ *
+ * @param vertices solid vertices
+ * @param indices solid triangles
+ * @param stars triangles around each vertex
+ * @param from vertex removed
+ * @param to vertex kept
+ * @return signed volume change, NAN if the edge can't be collapsed
+ */
+double EdgeCollapser::getCollapseChange(const std::vector<Point3f>& vertices, const std::vector<int>& indices, const std::vector<std::vector<int>>& stars, int from, int to)
+{
+	//neighbours of both ends: every edge must be shared by two triangles
+	std::map<int,int> neighbours[2];
+	int ends[2] = {from, to};
+	for(int end=0;end<2;end++)
+	{
+		for(int triangle : stars[ends[end]])
+		{
+			for(int corner=0;corner<3;corner++)
+			{
+				int vertex = indices[3*triangle+corner];
+				if(vertex!=ends[end])
+				{
+					neighbours[end][vertex]++;
+				}
+			}
+		}
+		for(const std::pair<const int,int>& neighbour : neighbours[end])
+		{
+			if(neighbour.second!=2)
+			{
+				return NAN;
+			}
+		}
+	}
+
+	//the two triangles on the edge, and their third vertices
+	std::vector<int> opposite;
+	for(int triangle : stars[from])
+	{
+		for(int corner=0;corner<3;corner++)
+		{
+			if(indices[3*triangle+corner]==to)
+			{
+				opposite.push_back(indices[3*triangle]+indices[3*triangle+1]+indices[3*triangle+2]-from-to);
+			}
+		}
+	}
+	if(opposite.size()!=2 || opposite[0]==opposite[1])
+	{
+		return NAN;
+	}
+
+	//link condition: the ends share no neighbour but the third vertices, which must
+	//keep three triangles at least
+	for(const std::pair<const int,int>& neighbour : neighbours[0])
+	{
+		if(neighbour.first!=to && neighbours[1].count(neighbour.first)!=0 && neighbour.first!=opposite[0] && neighbour.first!=opposite[1])
+		{
+			return NAN;
+		}
+	}
+	if(stars[opposite[0]].size()<=3 || stars[opposite[1]].size()<=3)
+	{
+		return NAN;
+	}
+
+	//the moved triangles keep their orientation; volume change of all, the removed ones included
+	const Point3f& start = vertices[from];
+	const Point3f& end = vertices[to];
+	Vector3f move = {end.x-start.x, end.y-start.y, end.z-start.z};
+	double change = 0;
+	for(int triangle : stars[from])
+	{
+		int corner = 0;
+		for(;indices[3*triangle+corner]!=from;corner++);
+		int next = indices[3*triangle+(corner+1)%3];
+		int previous = indices[3*triangle+(corner+2)%3];
+		const Point3f& p2 = vertices[next];
+		const Point3f& p3 = vertices[previous];
+		if(next!=to && previous!=to)
+		{
+			Vector3f edge2 = {p3.x-p2.x, p3.y-p2.y, p3.z-p2.z};
+			Vector3f old1 = {start.x-p2.x, start.y-p2.y, start.z-p2.z};
+			Vector3f new1 = {end.x-p2.x, end.y-p2.y, end.z-p2.z};
+			Vector3f oldNormal, newNormal;
+			oldNormal.cross(edge2, old1);
+			newNormal.cross(edge2, new1);
+			if(oldNormal.dot(newNormal)<=0)
+			{
+				return NAN;
+			}
+		}
+		Vector3f v2 = p2;
+		Vector3f v3 = p3;
+		Vector3f cross;
+		cross.cross(v2, v3);
+		change += move.dot(cross);
+	}
+	return change/6;
+}
+
+/**
+ * Moves a vertex onto a neighbour: the two triangles on their edge die and the
+ * others around the vertex take the neighbour instead
+ *
+ * @param indices solid triangles
+ * @param stars triangles around each vertex
+ * @param alive false for the triangles removed
+ * @param from vertex removed
+ * @param to vertex kept
+ */
+void EdgeCollapser::applyCollapse(std::vector<int>& indices, std::vector<std::vector<int>>& stars, std::vector<char>& alive, int from, int to)
+{
+	for(int triangle : stars[from])
+	{
+		int* corners = &indices[3*triangle];
+		if(corners[0]==to || corners[1]==to || corners[2]==to)
+		{
+			alive[triangle] = 0;
+			for(int corner=0;corner<3;corner++)
+			{
+				std::vector<int>& star = stars[corners[corner]];
+				if(corners[corner]!=from)
+				{
+					star.erase(std::find(star.begin(), star.end(), triangle));
+				}
+			}
+			continue;
+		}
+		std::replace(corners, corners+3, from, to);
+		stars[to].push_back(triangle);
+	}
+	stars[from].clear();
+}
+
+/**
+ * Gets the length of the shortest edge of a triangle
+ *
+ * @param vertices solid vertices
+ * @param indices solid triangles
+ * @param triangle triangle to measure
+ * @return shortest edge length
+ */
+double EdgeCollapser::getShortestEdge(const std::vector<Point3f>& vertices, const std::vector<int>& indices, int triangle)
+{
+	const Point3f& p1 = vertices[indices[3*triangle]];
+	const Point3f& p2 = vertices[indices[3*triangle+1]];
+	const Point3f& p3 = vertices[indices[3*triangle+2]];
+	return std::min(std::min(p1.distance(p2), p2.distance(p3)), p3.distance(p1));
+}
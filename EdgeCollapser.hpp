@@ -0,0 +1,45 @@
+#ifndef __EDGE_COLLAPSER__
+#define __EDGE_COLLAPSER__
+
+#include<vector>
+#include"Point3f.hpp"
+
+/**
+ * Removes needle and tiny triangles from a solid by collapsing their edges.
+ *
+ * <br><br>The triangles are first split at the T-junctions of the solid (vertices lying
+ * inside the edge of another triangle), which the composition leaves along the
+ * intersection curves, where most needles are.
+ *
+ * <br><br>A triangle is bad if its quality (see getQuality) is under a threshold or its
+ * shortest edge is shorter than a length. Its edges are tried from the shortest: one
+ * end moves onto the other, so no new position is made up, and the two triangles
+ * sharing the edge disappear. A collapse is refused if it would change the topology
+ * (the edge and its ends must be manifold and satisfy the link condition), flip the
+ * normal of any triangle, or take the volume change of the whole pass over its bound.
+ * Of the two directions, the one changing the volume less is taken.
+ *
+ * @author akatsia-games on github.com
+ */
+class EdgeCollapser
+{
+public:
+	static int collapse(std::vector<Point3f>& vertices, std::vector<int>& indices, std::vector<Colour3f>& colors, double minQuality, double minEdgeLength, double maxVolumeChange);
+
+	static double getQuality(const Point3f& p1, const Point3f& p2, const Point3f& p3);
+
+private:
+	static void splitJunctions(const std::vector<Point3f>& vertices, std::vector<int>& indices);
+
+	static void splitTriangle(const int corners[3], const std::vector<int> edgeVertices[3], std::vector<int>& output);
+
+	static double getCollapseChange(const std::vector<Point3f>& vertices, const std::vector<int>& indices, const std::vector<std::vector<int>>& stars, int from, int to);
+
+	static void applyCollapse(std::vector<int>& indices, std::vector<std::vector<int>>& stars, std::vector<char>& alive, int from, int to);
+
+	static double getShortestEdge(const std::vector<Point3f>& vertices, const std::vector<int>& indices, int triangle);
+
+	/** distance under which a vertex lies on an edge, making a T-junction there, the Vertex tolerance */
+	constexpr static const double JUNCTION_TOL = 1e-5;
+};
+#endif //__EDGE_COLLAPSER__
@@ -1,7 +1,9 @@
 #include "Face.hpp"
 #include "Line.hpp"
 #include "Object3D.hpp"
+#include "WindingNumber.hpp"
 #include<cmath>
+#include<algorithm>
 
 /**
  * Representation of a 3D face (triangle).
@@ -29,6 +31,7 @@ Face::Face(std::vector<Vertex>& solidVertices)
 	:v{0,0,0}
 	,solidVertices(solidVertices)
 	,testedUntil(0)
+	,source(-1)
 {
 	status = Face::INVALID;
 }
@@ -39,11 +42,14 @@ Face::Face(std::vector<Vertex>& solidVertices)
  * @param v1 a face vertex
  * @param v2 a face vertex
  * @param v3 a face vertex
+ * @param testedUntil first face of the other object still to be tested against this face
+ * @param source index of the input triangle this face is a fragment of (-1 if none)
  */
-Face::Face(std::vector<Vertex>& solidVertices, int v1, int v2, int v3, int testedUntil)
+Face::Face(std::vector<Vertex>& solidVertices, int v1, int v2, int v3, int testedUntil, int source)
 	:v{v1, v2, v3}
 	,solidVertices(solidVertices)
 	,testedUntil(testedUntil)
+	,source(source)
 {
 	status = Face::UNKNOWN;
 }
@@ -60,6 +66,7 @@ Face::Face(const Face& other)
 	,status(other.status)
 	,solidVertices(other.solidVertices)
 	,testedUntil(other.testedUntil)
+	,source(other.source)
 {
 }
 
@@ -70,6 +77,7 @@ Face& Face::operator=(const Face& other){
 	v[2] = other.v[2];
 	status = other.status;
 	testedUntil = other.testedUntil;
+	source = other.source;
 	return *this;
 }
 
@@ -213,6 +221,16 @@ int Face::getStart() const{
 	return testedUntil;
 }
 
+/**
+ * Gets the input triangle this face is a fragment of
+ * 
+ * @return index of the triangle on the solid the object was built from, -1 if none
+ */
+int Face::getSource() const
+{
+	return source;
+}
+
 //-------------------------------------OTHERS-----------------------------------//
 
 /** Invert face direction (normal direction) */
@@ -261,8 +279,9 @@ bool Face::simpleClassify()
  * Classifies the face based on the ray trace technique
  * 
  * @param object object3d used to compute the face status 
+ * @return number of times the ray was perturbed and traced again
  */
-void Face::rayTraceClassify(Object3D& object)
+int Face::rayTraceClassify(Object3D& object)
 {
 	//creating a ray starting starting at the face baricenter going to the normal direction
 	Point3f p0;
@@ -276,11 +295,13 @@ void Face::rayTraceClassify(Object3D& object)
 	Point3f intersectionPoint;
 	Face closestFace(object.vertices); //construct invalid face
 	double closestDistance; 
+	int retries = -1;
 								
 	do
 	{
 		success = true;
 		closestDistance = __DBL_MAX__;
+		retries++;
 		//for each face from the other solid...
 		for(int i=0;i<object.getNumFaces();i++)
 		{
@@ -368,6 +389,51 @@ void Face::rayTraceClassify(Object3D& object)
 			status = OUTSIDE;
 		}
 	}
+	return retries;
+}
+
+/**
+ * Classifies the face based on the generalized winding number of the other object.
+ * 
+ * <br><br>The winding number is sampled slightly in front of and behind the face 
+ * baricenter: if both samples agree the face is INSIDE or OUTSIDE, otherwise the face
+ * lies on the other object surface and the side found inside tells SAME from OPPOSITE.
+ * Unlike the ray trace, it needs no retries and tolerates cracks in the other object. 
+ * 
+ * @param windingNumber winding number of the object used to compute the face status
+ */
+void Face::windingNumberClassify(const WindingNumber& windingNumber)
+{
+	Point3f p0;
+	p0.x = (v1().x + v2().x + v3().x)/3.0;
+	p0.y = (v1().y + v2().y + v3().y)/3.0;
+	p0.z = (v1().z + v2().z + v3().z)/3.0;
+	Vector3f normal = getNormal();
+	
+	double longestEdge = std::max(v1().getPosition().distance(v2().getPosition()), 
+		std::max(v2().getPosition().distance(v3().getPosition()), v3().getPosition().distance(v1().getPosition())));
+	double offset = std::max(SAMPLE_OFFSET*longestEdge, 100*TOL);
+	
+	bool frontInside = windingNumber.isInside({p0.x+normal.x*offset, p0.y+normal.y*offset, p0.z+normal.z*offset});
+	bool backInside = windingNumber.isInside({p0.x-normal.x*offset, p0.y-normal.y*offset, p0.z-normal.z*offset});
+	
+	if(frontInside && backInside)
+	{
+		status = INSIDE;
+	}
+	else if(!frontInside && !backInside)
+	{
+		status = OUTSIDE;
+	}
+	//the other solid lies behind the face: both normals point the same way
+	else if(backInside)
+	{
+		status = SAME;
+	}
+	else
+	{
+		status = OPPOSITE;
+	}
 }
 
 //------------------------------------PRIVATES----------------------------------//
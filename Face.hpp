@@ -8,6 +8,7 @@
 
 class Object3D;
 class Segment;
+class WindingNumber;
 
 /**
  * Representation of a 3D face (triangle).
@@ -53,7 +54,7 @@ public:
 	
 	Face(std::vector<Vertex>& solidVertices);
 
-	Face(std::vector<Vertex>& solidVertices, int v1, int v2, int v3, int testedUntil=0);
+	Face(std::vector<Vertex>& solidVertices, int v1, int v2, int v3, int testedUntil=0, int source=-1);
 	
 	Face(const Face& other);
 	
@@ -73,13 +74,17 @@ public:
 	
 	int getStart()const;
 	
+	int getSource()const;
+	
 	void invert();
 		
 	//------------------------------------CLASSIFIERS-------------------------------//
 	
 	bool simpleClassify();
 	
-	void rayTraceClassify(Object3D& object);
+	int rayTraceClassify(Object3D& object);
+	
+	void windingNumberClassify(const WindingNumber& windingNumber);
 	
 private:
 	bool hasPoint(Point3f& point);
@@ -102,6 +107,9 @@ private:
 
 	int testedUntil;
 	
+	/** index of the input triangle this face is a fragment of */
+	int source;
+	
 	/** point status if it is up relative to an edge - see linePositionIn_ methods */
 	static const int UP = 6;
 	/** point status if it is down relative to an edge - see linePositionIn_ methods */
@@ -113,5 +121,7 @@ private:
 	
 	/** tolerance value to test equalities */
 	constexpr static const double TOL = 1e-10;
+	/** distance, relative to the longest edge, of the points sampled around the baricenter */
+	constexpr static const double SAMPLE_OFFSET = 1e-6;
 };
 #endif //__FACE__
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include "FaceSplitter.hpp"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Triangulation of a face constrained by the segments where other faces cross it.
+ *
+ * @author akatsia-games on github.com
+ */
+
+/**
+ * Constructs a triangulation made of the face alone
+ *
+ * @param p1 first face corner
+ * @param p2 second face corner
+ * @param p3 third face corner
+ */
+FaceSplitter::FaceSplitter(const Point3f& p1, const Point3f& p2, const Point3f& p3)
+	:points({p1, p2, p3})
+	,onSegment(3, 0)
+	,triangles({0, 1, 2})
+{
+	//project on the plane most aligned with the face, keeping it counterclockwise
+	Vector3f edge1 = {p2.x-p1.x, p2.y-p1.y, p2.z-p1.z};
+	Vector3f edge2 = {p3.x-p1.x, p3.y-p1.y, p3.z-p1.z};
+	Vector3f normal;
+	normal.cross(edge1, edge2);
+	double components[3] = {std::abs(normal.x), std::abs(normal.y), std::abs(normal.z)};
+	axis = components[0]>=components[1] && components[0]>=components[2] ? 0 : (components[1]>=components[2] ? 1 : 2);
+	flip = (axis==0 ? normal.x : (axis==1 ? normal.y : normal.z))<0;
+	for(const Point3f& point : points)
+	{
+		double u, v;
+		project(point, u, v);
+		us.push_back(u);
+		vs.push_back(v);
+	}
+}
+
+/**
+ * Inserts a segment lying on the face, so that it is made of triangulation edges
+ *
+ * @param start segment start
+ * @param end segment end
+ */
+void FaceSplitter::addSegment(const Point3f& start, const Point3f& end)
+{
+	int a = insertPoint(start);
+	int b = insertPoint(end);
+	onSegment[a] = 1;
+	onSegment[b] = 1;
+	if(a==b)
+	{
+		return;
+	}
+
+	//points where the segment crosses the edges, and points lying on it
+	std::vector<Point3f> crossings;
+	double du = us[b]-us[a];
+	double dv = vs[b]-vs[a];
+	for(size_t i=0;i<triangles.size();i++)
+	{
+		int p = triangles[i];
+		int q = triangles[i%3==2 ? i-2 : i+1];
+		if(p!=a && p!=b && isOnLine(a, b, points[p]))
+		{
+			double t = (us[p]-us[a])*du+(vs[p]-vs[a])*dv;
+			if(t>0 && t<du*du+dv*dv)
+			{
+				onSegment[p] = 1;
+			}
+		}
+		if(p==a || p==b || q==a || q==b)
+		{
+			continue;
+		}
+		double eu = us[q]-us[p];
+		double ev = vs[q]-vs[p];
+		double denominator = du*ev-dv*eu;
+		if(denominator==0)
+		{
+			continue;
+		}
+		double s = ((us[p]-us[a])*ev-(vs[p]-vs[a])*eu)/denominator;
+		double r = ((us[p]-us[a])*dv-(vs[p]-vs[a])*du)/denominator;
+		if(s>0 && s<1 && r>0 && r<1)
+		{
+			const Point3f& pp = points[p];
+			const Point3f& pq = points[q];
+			crossings.push_back(Point3f(pp.x+r*(pq.x-pp.x), pp.y+r*(pq.y-pp.y), pp.z+r*(pq.z-pp.z)));
+		}
+	}
+
+	for(const Point3f& crossing : crossings)
+	{
+		onSegment[insertPoint(crossing)] = 1;
+	}
+}
+
+/**
+ * Gets the memory allocated by the triangulation
+ *
+ * @return allocated bytes
+ */
+size_t FaceSplitter::getMemoryUsage() const
+{
+	return points.capacity()*sizeof(Point3f) + (us.capacity()+vs.capacity())*sizeof(double) + onSegment.capacity() + triangles.capacity()*sizeof(int);
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/**
+ * Inserts a point, splitting the triangles containing it
+ *
+ * @param point point to insert
+ * @return point position, an existing one if it was close enough
+ */
+int FaceSplitter::insertPoint(const Point3f& point)
+{
+	//an existing point is taken as it is, but still splits the triangles whose edges
+	//it lies on, in case it was inserted off them
+	int index = -1;
+	for(size_t i=0;i<points.size() && index<0;i++)
+	{
+		if(std::abs(points[i].x-point.x)<VERTEX_TOL && std::abs(points[i].y-point.y)<VERTEX_TOL && std::abs(points[i].z-point.z)<VERTEX_TOL)
+		{
+			index = i;
+		}
+	}
+	if(index<0)
+	{
+		index = points.size();
+		double u, v;
+		project(point, u, v);
+		points.push_back(point);
+		us.push_back(u);
+		vs.push_back(v);
+		onSegment.push_back(0);
+	}
+	const Point3f& position = points[index];
+	double u = us[index];
+	double v = vs[index];
+
+	size_t numTriangles = triangles.size();
+	for(size_t i=0;i<numTriangles;i+=3)
+	{
+		int corners[3] = {triangles[i], triangles[i+1], triangles[i+2]};
+		if(corners[0]==index || corners[1]==index || corners[2]==index)
+		{
+			continue;
+		}
+
+		//edge the point lies on, or -1; the point must be on the inner side of the others
+		int edge = -1;
+		bool inside = true;
+		for(int j=0;j<3 && inside;j++)
+		{
+			int a = corners[j];
+			int b = corners[(j+1)%3];
+			if(isOnLine(a, b, position))
+			{
+				inside = edge<0;
+				edge = j;
+			}
+			else
+			{
+				inside = getSide(a, b, u, v)>0;
+			}
+		}
+		if(!inside)
+		{
+			continue;
+		}
+
+		if(edge<0)
+		{
+			triangles[i+2] = index;
+			triangles.insert(triangles.end(), {corners[1], corners[2], index, corners[2], corners[0], index});
+		}
+		else
+		{
+			int a = corners[edge];
+			int b = corners[(edge+1)%3];
+			int c = corners[(edge+2)%3];
+			triangles[i] = a;
+			triangles[i+1] = index;
+			triangles[i+2] = c;
+			triangles.insert(triangles.end(), {index, b, c});
+		}
+	}
+	return index;
+}
+
+/**
+ * Checks if a point lies on the line through two points: the triangle they make is
+ * thinner than the edge tolerance or smaller than the area tolerance
+ *
+ * @param a first point position
+ * @param b second point position
+ * @param point point to check
+ * @return true if the point is on the line
+ */
+bool FaceSplitter::isOnLine(int a, int b, const Point3f& point) const
+{
+	Vector3f edge = {points[b].x-points[a].x, points[b].y-points[a].y, points[b].z-points[a].z};
+	Vector3f offset = {point.x-points[a].x, point.y-points[a].y, point.z-points[a].z};
+	Vector3f cross;
+	cross.cross(edge, offset);
+	double doubleArea = cross.length();
+	return doubleArea<=2*AREA_TOL || doubleArea<=EDGE_TOL*edge.length();
+}
+
+/**
+ * Gets the side of a projected point relative to the line through two points
+ *
+ * @param a first point position
+ * @param b second point position
+ * @param u projected u coordinate
+ * @param v projected v coordinate
+ * @return positive if the point is to the left, negative to the right
+ */
+double FaceSplitter::getSide(int a, int b, double u, double v) const
+{
+	return (us[b]-us[a])*(v-vs[a])-(vs[b]-vs[a])*(u-us[a]);
+}
+
+/**
+ * Projects a point on the plane most aligned with the face
+ *
+ * @param point point to project
+ * @param u output, first coordinate
+ * @param v output, second coordinate
+ */
+void FaceSplitter::project(const Point3f& point, double& u, double& v) const
+{
+	u = axis==0 ? point.y : (axis==1 ? point.z : point.x);
+	v = axis==0 ? point.z : (axis==1 ? point.x : point.y);
+	if(flip)
+	{
+		std::swap(u, v);
+	}
+}
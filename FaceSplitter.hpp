@@ -0,0 +1,102 @@
+#ifndef __FACE_SPLITTER__
+#define __FACE_SPLITTER__
+
+#include<vector>
+#include"Point3f.hpp"
+
+/**
+ * Triangulation of a face constrained by the segments where other faces cross it.
+ *
+ * <br><br>Starts with the face itself. Each segment end is inserted as a point, which
+ * splits the triangles containing it (in three, or in two if it lies on an edge), then
+ * the points where the segment crosses the existing edges are inserted as well. Every
+ * triangle touching an inserted point gets it as a corner, so once all of them are in,
+ * the pieces of the segment between consecutive points are edges of the triangulation.
+ *
+ * <br><br>Points closer than the Vertex tolerance are merged, and points nearly on an
+ * edge (or making a triangle smaller than the Face area tolerance) are taken as lying
+ * on it, so that no triangle is dropped when the faces are added to the object.
+ *
+ * @author akatsia-games on github.com
+ */
+class FaceSplitter
+{
+public:
+	FaceSplitter(const Point3f& p1, const Point3f& p2, const Point3f& p3);
+
+	void addSegment(const Point3f& start, const Point3f& end);
+
+	/**
+	 * Gets the number of points, the face corners being the first three
+	 *
+	 * @return number of points
+	 */
+	int getNumPoints() const
+	{
+		return points.size();
+	}
+
+	/**
+	 * Gets a point
+	 *
+	 * @param index point position (0 to 2 for the face corners)
+	 * @return point position
+	 */
+	const Point3f& getPoint(int index) const
+	{
+		return points[index];
+	}
+
+	/**
+	 * Checks if a point lies on a segment
+	 *
+	 * @param index point position
+	 * @return true if some segment goes through the point
+	 */
+	bool isOnSegment(int index) const
+	{
+		return onSegment[index];
+	}
+
+	/**
+	 * Gets the triangles, three point positions each, with the orientation of the face
+	 *
+	 * @return triangle corners
+	 */
+	const std::vector<int>& getTriangles() const
+	{
+		return triangles;
+	}
+
+	size_t getMemoryUsage() const;
+
+private:
+	int insertPoint(const Point3f& point);
+
+	bool isOnLine(int a, int b, const Point3f& point) const;
+
+	double getSide(int a, int b, double u, double v) const;
+
+	void project(const Point3f& point, double& u, double& v) const;
+
+	/** point positions */
+	std::vector<Point3f> points;
+	/** projected point coordinates */
+	std::vector<double> us, vs;
+	/** true for the points some segment goes through */
+	std::vector<char> onSegment;
+	/** triangle corners, three per triangle */
+	std::vector<int> triangles;
+	/** coordinate dropped by the projection (0 x, 1 y, 2 z) */
+	int axis;
+	/** true if the projected coordinates are swapped to keep the face counterclockwise */
+	bool flip;
+
+	/** distance (on each coordinate) under which two points are the same, as in Vertex */
+	constexpr static const double VERTEX_TOL = 1e-5;
+	/** distance under which a point lies on an edge */
+	constexpr static const double EDGE_TOL = 1e-8;
+	/** area under which a triangle is degenerate, as in Object3D::addFace */
+	constexpr static const double AREA_TOL = 1e-10;
+};
+#endif //__FACE_SPLITTER__
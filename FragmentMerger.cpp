@@ -0,0 +1,802 @@
+#include "FragmentMerger.hpp"
+#include "Parallel.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <set>
+
+/**
+ * Merges the fragments a split left of each input triangle back into as few
+ * triangles as possible.
+ *
+ * @author akatsia-games on github.com
+ */
+
+/**
+ * Merges the coplanar regions of a solid and triangulates them again. Vertices no
+ * longer used are removed.
+ *
+ * @param vertices solid vertices, compacted on return
+ * @param indices solid triangles (three indices each), replaced on return
+ * @param colors vertex colors, compacted with the vertices
+ * @param groups group of each triangle (the input triangle it comes from), -1 for none
+ * @return number of triangles removed
+ */
+int FragmentMerger::merge(std::vector<Point3f>& vertices, std::vector<int>& indices, std::vector<Colour3f>& colors, const std::vector<int>& groups)
+{
+	TRACE_SCOPE("FragmentMerger::merge");
+	int numTriangles = indices.size()/3;
+
+	//triangles sorted by region, and the ranges of the regions worth merging
+	std::vector<int> regions;
+	findRegions(vertices, indices, groups, regions);
+	std::vector<int> order(numTriangles);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&regions](int a, int b){ return regions[a]<regions[b]; });
+	std::vector<std::pair<int,int>> ranges;
+	std::vector<char> fixed(vertices.size(), 0);
+	for(int begin=0, end;begin<numTriangles;begin=end)
+	{
+		for(end=begin+1;end<numTriangles && regions[order[end]]==regions[order[begin]];end++);
+		if(end-begin>1 && end-begin<=MAX_GROUP_SIZE)
+		{
+			ranges.push_back({begin, end});
+		}
+		else
+		{
+			//triangles kept as they are: their vertices stay
+			for(int i=begin;i<end;i++)
+			{
+				for(int corner=0;corner<3;corner++)
+				{
+					fixed[indices[3*order[i]+corner]] = 1;
+				}
+			}
+		}
+	}
+
+	//a vertex shared by several regions may only be removed if all of them remove it:
+	//the vertices some region keeps are fixed and the regions are merged again, until
+	//no region keeps a vertex the others removed
+	std::vector<std::vector<int>> results(ranges.size());
+	std::vector<char> merged(ranges.size(), 0);
+	bool changed = true;
+	while(changed)
+	{
+		Parallel::forEach(0, ranges.size(), [&](int range)
+		{
+			std::vector<int> triangles(order.begin()+ranges[range].first, order.begin()+ranges[range].second);
+			results[range].clear();
+			merged[range] = mergeGroup(vertices, indices, fixed, triangles, results[range]);
+		}, 16);
+
+		changed = false;
+		for(size_t range=0;range<ranges.size();range++)
+		{
+			if(merged[range])
+			{
+				for(int index : results[range])
+				{
+					changed |= !fixed[index];
+					fixed[index] = 1;
+				}
+				continue;
+			}
+			for(int i=ranges[range].first;i<ranges[range].second;i++)
+			{
+				for(int corner=0;corner<3;corner++)
+				{
+					int index = indices[3*order[i]+corner];
+					changed |= !fixed[index];
+					fixed[index] = 1;
+				}
+			}
+		}
+	}
+
+	//unmerged triangles first, then the triangulations
+	std::vector<char> removed(numTriangles, 0);
+	for(size_t range=0;range<ranges.size();range++)
+	{
+		if(merged[range])
+		{
+			for(int i=ranges[range].first;i<ranges[range].second;i++)
+			{
+				removed[order[i]] = 1;
+			}
+		}
+	}
+	std::vector<int> newIndices;
+	newIndices.reserve(indices.size());
+	for(int i=0;i<numTriangles;i++)
+	{
+		if(!removed[i])
+		{
+			newIndices.insert(newIndices.end(), indices.begin()+3*i, indices.begin()+3*i+3);
+		}
+	}
+	for(size_t range=0;range<ranges.size();range++)
+	{
+		if(merged[range])
+		{
+			newIndices.insert(newIndices.end(), results[range].begin(), results[range].end());
+		}
+	}
+
+	//remove the vertices left unused
+	std::vector<int> remap(vertices.size(), -1);
+	std::vector<Point3f> newVertices;
+	std::vector<Colour3f> newColors;
+	for(int& index : newIndices)
+	{
+		if(remap[index]<0)
+		{
+			remap[index] = newVertices.size();
+			newVertices.push_back(vertices[index]);
+			newColors.push_back(colors[index]);
+		}
+		index = remap[index];
+	}
+	vertices.swap(newVertices);
+	colors.swap(newColors);
+
+	indices.swap(newIndices);
+	return numTriangles-indices.size()/3;
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/**
+ * Finds the coplanar regions of a solid: the fragments of the same input triangle,
+ * joined with the coplanar triangles sharing an edge with them.
+ *
+ * @param vertices solid vertices
+ * @param indices solid triangles
+ * @param groups group of each triangle, -1 for none
+ * @param regions output, the region of each triangle (the smallest triangle in it)
+ */
+void FragmentMerger::findRegions(const std::vector<Point3f>& vertices, const std::vector<int>& indices, const std::vector<int>& groups, std::vector<int>& regions)
+{
+	int numTriangles = indices.size()/3;
+	regions.resize(numTriangles);
+	std::iota(regions.begin(), regions.end(), 0);
+	auto find = [&regions](int triangle)
+	{
+		while(regions[triangle]!=triangle)
+		{
+			triangle = regions[triangle] = regions[regions[triangle]];
+		}
+		return triangle;
+	};
+	auto join = [&regions, &find](int triangle1, int triangle2)
+	{
+		int region1 = find(triangle1);
+		int region2 = find(triangle2);
+		regions[std::max(region1, region2)] = std::min(region1, region2);
+	};
+
+	//unit normals, null for degenerate triangles
+	std::vector<Vector3f> normals(numTriangles);
+	for(int i=0;i<numTriangles;i++)
+	{
+		const Point3f& p1 = vertices[indices[3*i]];
+		const Point3f& p2 = vertices[indices[3*i+1]];
+		const Point3f& p3 = vertices[indices[3*i+2]];
+		Vector3f edge1 = {p2.x-p1.x, p2.y-p1.y, p2.z-p1.z};
+		Vector3f edge2 = {p3.x-p1.x, p3.y-p1.y, p3.z-p1.z};
+		normals[i].cross(edge1, edge2);
+		double length = normals[i].length();
+		normals[i] = length==0 ? Vector3f{0, 0, 0} : Vector3f{normals[i].x/length, normals[i].y/length, normals[i].z/length};
+	}
+
+	std::map<int,int> first;
+	for(int i=0;i<numTriangles;i++)
+	{
+		if(groups[i]<0)
+		{
+			continue;
+		}
+		auto found = first.emplace(groups[i], i);
+		if(!found.second)
+		{
+			join(found.first->second, i);
+		}
+	}
+
+	//triangles sharing an edge, with the same orientation
+	std::map<std::pair<int,int>, int> edges;
+	for(int i=0;i<numTriangles;i++)
+	{
+		for(int corner=0;corner<3;corner++)
+		{
+			int start = indices[3*i+corner];
+			int end = indices[3*i+(corner+1)%3];
+			auto found = edges.emplace(std::make_pair(std::min(start, end), std::max(start, end)), i);
+			if(found.second)
+			{
+				continue;
+			}
+			int other = found.first->second;
+			Vector3f cross;
+			cross.cross(normals[i], normals[other]);
+			if(normals[i].dot(normals[other])>0 && cross.dot(cross)<=TOL*TOL)
+			{
+				join(i, other);
+			}
+		}
+	}
+
+	for(int i=0;i<numTriangles;i++)
+	{
+		regions[i] = find(i);
+	}
+}
+
+/**
+ * Merges the triangles of a group
+ *
+ * @param vertices solid vertices
+ * @param indices solid triangles
+ * @param fixed vertices that must stay
+ * @param triangles triangles of the group
+ * @param output triangles replacing the group
+ * @return false if the group must be kept as it is
+ */
+bool FragmentMerger::mergeGroup(const std::vector<Point3f>& vertices, const std::vector<int>& indices, const std::vector<char>& fixed, const std::vector<int>& triangles, std::vector<int>& output)
+{
+	std::vector<std::vector<int>> loops;
+	if(!findLoops(vertices, indices, triangles, loops))
+	{
+		return false;
+	}
+
+	//group normal and area
+	Vector3f normal = {0, 0, 0};
+	double area = 0;
+	std::set<int> groupVertices;
+	for(int triangle : triangles)
+	{
+		const Point3f& p1 = vertices[indices[3*triangle]];
+		const Point3f& p2 = vertices[indices[3*triangle+1]];
+		const Point3f& p3 = vertices[indices[3*triangle+2]];
+		Vector3f edge1 = {p2.x-p1.x, p2.y-p1.y, p2.z-p1.z};
+		Vector3f edge2 = {p3.x-p1.x, p3.y-p1.y, p3.z-p1.z};
+		Vector3f cross;
+		cross.cross(edge1, edge2);
+		normal += cross;
+		area += getArea(p1, p2, p3);
+		groupVertices.insert(indices.begin()+3*triangle, indices.begin()+3*triangle+3);
+	}
+
+	//vertices inside the polygons disappear: none may be fixed
+	std::set<int> onLoops;
+	for(const std::vector<int>& loop : loops)
+	{
+		onLoops.insert(loop.begin(), loop.end());
+	}
+	for(int vertex : groupVertices)
+	{
+		if(onLoops.count(vertex)==0 && fixed[vertex])
+		{
+			return false;
+		}
+	}
+
+	//drop the collinear boundary vertices that aren't fixed
+	for(std::vector<int>& loop : loops)
+	{
+		bool changed = true;
+		while(changed && loop.size()>3)
+		{
+			changed = false;
+			for(size_t i=0;i<loop.size() && loop.size()>3;i++)
+			{
+				int previous = loop[(i+loop.size()-1)%loop.size()];
+				int next = loop[(i+1)%loop.size()];
+				if(!fixed[loop[i]] && isCollinear(vertices[previous], vertices[loop[i]], vertices[next]))
+				{
+					loop.erase(loop.begin()+i);
+					changed = true;
+					i--;
+				}
+			}
+		}
+	}
+
+	//project on the plane most aligned with the group: outer loops turn
+	//counterclockwise, holes clockwise
+	double components[3] = {std::abs(normal.x), std::abs(normal.y), std::abs(normal.z)};
+	int axis = std::max_element(components, components+3)-components;
+	bool flip = (axis==0 ? normal.x : (axis==1 ? normal.y : normal.z))<0;
+	std::vector<std::vector<int>> outers, holes;
+	for(std::vector<int>& loop : loops)
+	{
+		(getSignedArea(vertices, loop, axis, flip)>0 ? outers : holes).push_back(loop);
+	}
+	if(!bridgeHoles(vertices, outers, holes, axis, flip))
+	{
+		return false;
+	}
+
+	for(const std::vector<int>& loop : outers)
+	{
+		if(!triangulate(vertices, loop, axis, flip, output))
+		{
+			return false;
+		}
+	}
+	if(output.size()/3>=triangles.size())
+	{
+		return false;
+	}
+
+	double newArea = 0;
+	for(size_t i=0;i<output.size();i+=3)
+	{
+		newArea += getArea(vertices[output[i]], vertices[output[i+1]], vertices[output[i+2]]);
+	}
+	return std::abs(newArea-area)<=1e-9*area;
+}
+
+/**
+ * Finds the boundary loops of the union of a group of triangles. Edges are first split
+ * at the group vertices lying on them, then the edges used in both directions cancel.
+ *
+ * @param vertices solid vertices
+ * @param indices solid triangles
+ * @param triangles triangles of the group
+ * @param loops output, the boundary loops in the triangles orientation
+ * @return false if the boundary isn't a set of closed loops visiting each vertex once
+ */
+bool FragmentMerger::findLoops(const std::vector<Point3f>& vertices, const std::vector<int>& indices, const std::vector<int>& triangles, std::vector<std::vector<int>>& loops)
+{
+	std::vector<int> groupVertices;
+	for(int triangle : triangles)
+	{
+		groupVertices.insert(groupVertices.end(), indices.begin()+3*triangle, indices.begin()+3*triangle+3);
+	}
+	std::sort(groupVertices.begin(), groupVertices.end());
+	groupVertices.erase(std::unique(groupVertices.begin(), groupVertices.end()), groupVertices.end());
+
+	std::map<std::pair<int,int>, int> edges;
+	std::vector<std::pair<double,int>> inner;
+	for(int triangle : triangles)
+	{
+		for(int corner=0;corner<3;corner++)
+		{
+			int start = indices[3*triangle+corner];
+			int end = indices[3*triangle+(corner+1)%3];
+			const Point3f& p = vertices[start];
+			const Point3f& q = vertices[end];
+			Vector3f direction = {q.x-p.x, q.y-p.y, q.z-p.z};
+			double lengthSquared = direction.dot(direction);
+
+			//group vertices on the edge (T-junctions), ordered from start to end
+			inner.clear();
+			for(int vertex : groupVertices)
+			{
+				const Point3f& w = vertices[vertex];
+				Vector3f offset = {w.x-p.x, w.y-p.y, w.z-p.z};
+				double t = offset.dot(direction)/lengthSquared;
+				if(vertex==start || vertex==end || t<=0 || t>=1)
+				{
+					continue;
+				}
+				Vector3f distance = {offset.x-t*direction.x, offset.y-t*direction.y, offset.z-t*direction.z};
+				if(distance.dot(distance)<=TOL*TOL*lengthSquared)
+				{
+					inner.push_back({t, vertex});
+				}
+			}
+			std::sort(inner.begin(), inner.end());
+
+			int previous = start;
+			for(const std::pair<double,int>& vertex : inner)
+			{
+				edges[{previous, vertex.second}]++;
+				previous = vertex.second;
+			}
+			edges[{previous, end}]++;
+		}
+	}
+
+	//edges left after cancelling the opposite ones, each vertex must start one at most
+	std::map<int,int> next;
+	for(const std::pair<const std::pair<int,int>, int>& edge : edges)
+	{
+		auto opposite = edges.find({edge.first.second, edge.first.first});
+		int count = edge.second-(opposite==edges.end() ? 0 : opposite->second);
+		if(count>1)
+		{
+			return false;
+		}
+		if(count==1 && !next.emplace(edge.first.first, edge.first.second).second)
+		{
+			return false;
+		}
+	}
+
+	while(!next.empty())
+	{
+		std::vector<int> loop;
+		int start = next.begin()->first;
+		int vertex = start;
+		do
+		{
+			auto found = next.find(vertex);
+			if(found==next.end())
+			{
+				return false;
+			}
+			loop.push_back(vertex);
+			vertex = found->second;
+			next.erase(found);
+		}while(vertex!=start);
+
+		if(loop.size()<3)
+		{
+			return false;
+		}
+		loops.push_back(loop);
+	}
+	return !loops.empty();
+}
+
+/**
+ * Joins each hole to the outer loop around it by a bridge from the hole vertex with
+ * the greatest projected u coordinate to the closest outer vertex it sees. The bridge
+ * is walked in both directions, so the outer loop becomes a single polygon.
+ *
+ * @param points solid vertices
+ * @param outers outer loops, counterclockwise; the holes are spliced into them
+ * @param holes hole loops, clockwise
+ * @param axis coordinate dropped to project the loops (0 x, 1 y, 2 z)
+ * @param flip true if the group normal points to the negative side of the axis
+ * @return false if a hole has no outer loop around it or no bridge was found
+ */
+bool FragmentMerger::bridgeHoles(const std::vector<Point3f>& points, std::vector<std::vector<int>>& outers, std::vector<std::vector<int>> holes, int axis, bool flip)
+{
+	//the holes reaching further right are bridged first, so bridges don't cross later holes
+	std::vector<std::pair<double,int>> order;
+	std::vector<int> rightmost(holes.size());
+	for(size_t i=0;i<holes.size();i++)
+	{
+		double bestU = -INFINITY;
+		for(size_t j=0;j<holes[i].size();j++)
+		{
+			double u, v;
+			project(points[holes[i][j]], axis, flip, u, v);
+			if(u>bestU)
+			{
+				bestU = u;
+				rightmost[i] = j;
+			}
+		}
+		order.push_back({-bestU, i});
+	}
+	std::sort(order.begin(), order.end());
+
+	std::vector<char> bridged(holes.size(), 0);
+	for(const std::pair<double,int>& next : order)
+	{
+		std::vector<int>& hole = holes[next.second];
+		int start = hole[rightmost[next.second]];
+		double hu, hv;
+		project(points[start], axis, flip, hu, hv);
+
+		//the smallest outer loop around the hole
+		int container = -1;
+		double containerArea = INFINITY;
+		for(size_t i=0;i<outers.size();i++)
+		{
+			double area = getSignedArea(points, outers[i], axis, flip);
+			if(area<containerArea && isInside(points, outers[i], hu, hv, axis, flip))
+			{
+				container = i;
+				containerArea = area;
+			}
+		}
+		if(container<0)
+		{
+			return false;
+		}
+
+		//closest vertex of the outer loop seen from the hole, through the polygon
+		std::vector<int>& outer = outers[container];
+		int best = -1;
+		double bestDistance = INFINITY;
+		for(size_t i=0;i<outer.size();i++)
+		{
+			double ou, ov;
+			project(points[outer[i]], axis, flip, ou, ov);
+			double distance = (ou-hu)*(ou-hu)+(ov-hv)*(ov-hv);
+			if(distance>=bestDistance)
+			{
+				continue;
+			}
+			bool visible = !isInside(points, hole, (hu+ou)/2, (hv+ov)/2, axis, flip);
+			for(size_t j=0;j<outers.size() && visible;j++)
+			{
+				visible = !crossesLoop(points, outers[j], start, outer[i], axis, flip);
+			}
+			for(size_t j=0;j<holes.size() && visible;j++)
+			{
+				visible = bridged[j] || !crossesLoop(points, holes[j], start, outer[i], axis, flip);
+			}
+			if(visible)
+			{
+				best = i;
+				bestDistance = distance;
+			}
+		}
+		if(best<0)
+		{
+			return false;
+		}
+
+		//outer up to the bridge, the hole from its start, back to the start and the outer
+		std::rotate(hole.begin(), hole.begin()+rightmost[next.second], hole.end());
+		std::vector<int> splice(outer.begin(), outer.begin()+best+1);
+		splice.insert(splice.end(), hole.begin(), hole.end());
+		splice.push_back(start);
+		splice.insert(splice.end(), outer.begin()+best, outer.end());
+		outer.swap(splice);
+		bridged[next.second] = 1;
+	}
+	return true;
+}
+
+/**
+ * Checks if a segment between two vertices crosses or touches a loop anywhere but at
+ * the two vertices
+ *
+ * @param points solid vertices
+ * @param loop loop vertices
+ * @param start segment start
+ * @param end segment end
+ * @param axis coordinate dropped to project the loop (0 x, 1 y, 2 z)
+ * @param flip true if the group normal points to the negative side of the axis
+ * @return true if the segment crosses the loop
+ */
+bool FragmentMerger::crossesLoop(const std::vector<Point3f>& points, const std::vector<int>& loop, int start, int end, int axis, bool flip)
+{
+	double su, sv, eu, ev;
+	project(points[start], axis, flip, su, sv);
+	project(points[end], axis, flip, eu, ev);
+	double lengthSquared = (eu-su)*(eu-su)+(ev-sv)*(ev-sv);
+	auto side = [&](double u, double v)
+	{
+		return (eu-su)*(v-sv)-(ev-sv)*(u-su);
+	};
+
+	for(size_t i=0;i<loop.size();i++)
+	{
+		int a = loop[i];
+		int b = loop[(i+1)%loop.size()];
+		double au, av, bu, bv;
+		project(points[a], axis, flip, au, av);
+		project(points[b], axis, flip, bu, bv);
+
+		//a loop vertex on the segment
+		if(a!=start && a!=end)
+		{
+			double t = (au-su)*(eu-su)+(av-sv)*(ev-sv);
+			double distance = side(au, av);
+			if(t>=0 && t<=lengthSquared && distance*distance<=TOL*TOL*lengthSquared*lengthSquared)
+			{
+				return true;
+			}
+		}
+		if(a==start || a==end || b==start || b==end)
+		{
+			continue;
+		}
+
+		//the segment and the edge cross each other
+		double sideA = side(au, av);
+		double sideB = side(bu, bv);
+		double sideS = (bu-au)*(sv-av)-(bv-av)*(su-au);
+		double sideE = (bu-au)*(ev-av)-(bv-av)*(eu-au);
+		if(((sideA>0 && sideB<0) || (sideA<0 && sideB>0)) && ((sideS>0 && sideE<0) || (sideS<0 && sideE>0)))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Checks if a point lies inside a loop, by the crossing number
+ *
+ * @param points solid vertices
+ * @param loop loop vertices
+ * @param u projected u coordinate of the point
+ * @param v projected v coordinate of the point
+ * @param axis coordinate dropped to project the loop (0 x, 1 y, 2 z)
+ * @param flip true if the group normal points to the negative side of the axis
+ * @return true if the point is inside
+ */
+bool FragmentMerger::isInside(const std::vector<Point3f>& points, const std::vector<int>& loop, double u, double v, int axis, bool flip)
+{
+	bool inside = false;
+	for(size_t i=0, j=loop.size()-1;i<loop.size();j=i++)
+	{
+		double iu, iv, ju, jv;
+		project(points[loop[i]], axis, flip, iu, iv);
+		project(points[loop[j]], axis, flip, ju, jv);
+		if((iv>v)!=(jv>v) && u<(ju-iu)*(v-iv)/(jv-iv)+iu)
+		{
+			inside = !inside;
+		}
+	}
+	return inside;
+}
+
+/**
+ * Triangulates a simple polygon by ear clipping. The polygon must turn counterclockwise
+ * seen from the group normal; it may walk a bridge to a hole twice.
+ *
+ * @param points solid vertices
+ * @param loop polygon vertices
+ * @param axis coordinate dropped to project the polygon (0 x, 1 y, 2 z)
+ * @param flip true if the group normal points to the negative side of the axis
+ * @param output triangles appended to
+ * @return false if the polygon couldn't be triangulated
+ */
+bool FragmentMerger::triangulate(const std::vector<Point3f>& points, const std::vector<int>& loop, int axis, bool flip, std::vector<int>& output)
+{
+	std::vector<double> u(loop.size()), v(loop.size());
+	double minU = INFINITY, maxU = -INFINITY, minV = INFINITY, maxV = -INFINITY;
+	for(size_t i=0;i<loop.size();i++)
+	{
+		project(points[loop[i]], axis, flip, u[i], v[i]);
+		minU = std::min(minU, u[i]);
+		maxU = std::max(maxU, u[i]);
+		minV = std::min(minV, v[i]);
+		maxV = std::max(maxV, v[i]);
+	}
+	double extent = std::max(maxU-minU, maxV-minV);
+	double eps = 1e-12*extent*extent;
+
+	auto cross = [&u, &v](int a, int b, int c)
+	{
+		return (u[b]-u[a])*(v[c]-v[a])-(v[b]-v[a])*(u[c]-u[a]);
+	};
+
+	if(getSignedArea(points, loop, axis, flip)<=eps)
+	{
+		return false;
+	}
+
+	std::vector<int> remaining(loop.size());
+	std::iota(remaining.begin(), remaining.end(), 0);
+	while(remaining.size()>3)
+	{
+		size_t count = remaining.size();
+		bool found = false;
+		for(size_t i=0;i<count && !found;i++)
+		{
+			int a = remaining[(i+count-1)%count];
+			int b = remaining[i];
+			int c = remaining[(i+1)%count];
+			if(cross(a, b, c)<=eps)
+			{
+				continue;
+			}
+
+			//no other vertex may lie inside the ear or on its edges (the copies of its
+			//corners on a bridge excepted)
+			bool blocked = false;
+			for(int r : remaining)
+			{
+				if(loop[r]==loop[a] || loop[r]==loop[b] || loop[r]==loop[c])
+				{
+					continue;
+				}
+				if(cross(a, b, r)>=-eps && cross(b, c, r)>=-eps && cross(c, a, r)>=-eps)
+				{
+					blocked = true;
+					break;
+				}
+			}
+			if(!blocked)
+			{
+				output.insert(output.end(), {loop[a], loop[b], loop[c]});
+				remaining.erase(remaining.begin()+i);
+				found = true;
+			}
+		}
+		if(!found)
+		{
+			return false;
+		}
+	}
+	if(cross(remaining[0], remaining[1], remaining[2])<=eps)
+	{
+		return false;
+	}
+	output.insert(output.end(), {loop[remaining[0]], loop[remaining[1]], loop[remaining[2]]});
+	return true;
+}
+
+/**
+ * Gets the signed area of a projected loop
+ *
+ * @param points solid vertices
+ * @param loop loop vertices
+ * @param axis coordinate dropped to project the loop (0 x, 1 y, 2 z)
+ * @param flip true if the group normal points to the negative side of the axis
+ * @return area, positive if the loop turns counterclockwise seen from the group normal
+ */
+double FragmentMerger::getSignedArea(const std::vector<Point3f>& points, const std::vector<int>& loop, int axis, bool flip)
+{
+	double area = 0;
+	for(size_t i=0, j=loop.size()-1;i<loop.size();j=i++)
+	{
+		double iu, iv, ju, jv;
+		project(points[loop[i]], axis, flip, iu, iv);
+		project(points[loop[j]], axis, flip, ju, jv);
+		area += ju*iv-iu*jv;
+	}
+	return area/2;
+}
+
+/**
+ * Projects a point on a coordinate plane. The remaining coordinates are taken in
+ * cyclic order (and swapped if flipped), so loops turning counterclockwise around the
+ * group normal turn counterclockwise in the plane.
+ *
+ * @param point point to project
+ * @param axis coordinate dropped (0 x, 1 y, 2 z)
+ * @param flip true if the group normal points to the negative side of the axis
+ * @param u output, first coordinate
+ * @param v output, second coordinate
+ */
+void FragmentMerger::project(const Point3f& point, int axis, bool flip, double& u, double& v)
+{
+	u = axis==0 ? point.y : (axis==1 ? point.z : point.x);
+	v = axis==0 ? point.z : (axis==1 ? point.x : point.y);
+	if(flip)
+	{
+		std::swap(u, v);
+	}
+}
+
+/**
+ * Checks if a point lies on the segment between two others
+ *
+ * @param previous segment start
+ * @param point point to check
+ * @param next segment end
+ * @return true if the point is on the segment, within the tolerance
+ */
+bool FragmentMerger::isCollinear(const Point3f& previous, const Point3f& point, const Point3f& next)
+{
+	Vector3f segment = {next.x-previous.x, next.y-previous.y, next.z-previous.z};
+	Vector3f offset = {point.x-previous.x, point.y-previous.y, point.z-previous.z};
+	double lengthSquared = segment.dot(segment);
+	double t = offset.dot(segment);
+	if(t<=0 || t>=lengthSquared)
+	{
+		return false;
+	}
+	Vector3f cross;
+	cross.cross(offset, segment);
+	return cross.dot(cross)<=TOL*TOL*lengthSquared*lengthSquared;
+}
+
+/**
+ * Computes the area of a triangle
+ *
+ * @return triangle area
+ */
+double FragmentMerger::getArea(const Point3f& p1, const Point3f& p2, const Point3f& p3)
+{
+	Vector3f edge1 = {p2.x-p1.x, p2.y-p1.y, p2.z-p1.z};
+	Vector3f edge2 = {p3.x-p1.x, p3.y-p1.y, p3.z-p1.z};
+	Vector3f cross;
+	cross.cross(edge1, edge2);
+	return cross.length()/2;
+}
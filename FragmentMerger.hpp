@@ -0,0 +1,60 @@
+#ifndef __FRAGMENT_MERGER__
+#define __FRAGMENT_MERGER__
+
+#include<vector>
+#include"Point3f.hpp"
+
+/**
+ * Merges the fragments a split left of each input triangle back into as few
+ * triangles as possible.
+ *
+ * <br><br>Every triangle of a composed solid carries a group: the input triangle it is
+ * a fragment of. The fragments of a group are coplanar; they are joined with the
+ * coplanar triangles sharing an edge with them, so that fragments left by earlier
+ * operations merge too. The union of a region is a polygon whose boundary is found by
+ * cancelling the edges shared by two triangles (after splitting edges at the
+ * T-junctions inside the region). The vertices inside the polygon are dropped, as are
+ * the boundary vertices collinear with their neighbours, and the polygon is
+ * triangulated again by ear clipping, with its holes bridged to the outer boundary.
+ *
+ * <br><br>A vertex shared by several regions is only dropped if all of them drop it.
+ * Regions whose boundary isn't a set of closed loops, or whose triangulation wouldn't
+ * have fewer triangles or the same area, are kept as they are, so the solid stays
+ * closed wherever it was.
+ *
+ * @author akatsia-games on github.com
+ */
+class FragmentMerger
+{
+public:
+	static int merge(std::vector<Point3f>& vertices, std::vector<int>& indices, std::vector<Colour3f>& colors, const std::vector<int>& groups);
+
+private:
+	static void findRegions(const std::vector<Point3f>& vertices, const std::vector<int>& indices, const std::vector<int>& groups, std::vector<int>& regions);
+
+	static bool mergeGroup(const std::vector<Point3f>& vertices, const std::vector<int>& indices, const std::vector<char>& fixed, const std::vector<int>& triangles, std::vector<int>& output);
+
+	static bool findLoops(const std::vector<Point3f>& vertices, const std::vector<int>& indices, const std::vector<int>& triangles, std::vector<std::vector<int>>& loops);
+
+	static bool bridgeHoles(const std::vector<Point3f>& points, std::vector<std::vector<int>>& outers, std::vector<std::vector<int>> holes, int axis, bool flip);
+
+	static bool crossesLoop(const std::vector<Point3f>& points, const std::vector<int>& loop, int start, int end, int axis, bool flip);
+
+	static bool isInside(const std::vector<Point3f>& points, const std::vector<int>& loop, double u, double v, int axis, bool flip);
+
+	static bool triangulate(const std::vector<Point3f>& points, const std::vector<int>& loop, int axis, bool flip, std::vector<int>& output);
+
+	static double getSignedArea(const std::vector<Point3f>& points, const std::vector<int>& loop, int axis, bool flip);
+
+	static void project(const Point3f& point, int axis, bool flip, double& u, double& v);
+
+	static bool isCollinear(const Point3f& previous, const Point3f& point, const Point3f& next);
+
+	static double getArea(const Point3f& p1, const Point3f& p2, const Point3f& p3);
+
+	/** largest region merged, bigger ones are kept (merging is quadratic in the region size) */
+	static const int MAX_GROUP_SIZE = 512;
+	/** tolerance, relative to the edge length, for a point to lie on an edge; also the sine below which two normals are parallel */
+	constexpr static const double TOL = 1e-8;
+};
+#endif //__FRAGMENT_MERGER__
@@ -0,0 +1,365 @@
+#include "IntersectionCurves.hpp"
+#include "Solid.hpp"
+#include "Object3D.hpp"
+#include "TriangleTree.hpp"
+#include "Parallel.hpp"
+#include "Trace.hpp"
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <set>
+
+/**
+ * Curves where the surfaces of two solids meet.
+ *
+ * @author akatsia-games on github.com
+ */
+
+//---------------------------------TRAVERSAL------------------------------------//
+
+/**
+ * Calls a function for every crossing pair of faces, in parallel over the faces of the
+ * first set. The pairs are found through a hierarchy over the second set.
+ *
+ * @param faces1 first set of faces
+ * @param faces2 second set of faces
+ * @param function function receiving the position of the face of the first set and
+ * the segment ends, returning false to stop the search
+ */
+template<typename Function>
+void IntersectionCurves::forEachCrossing(const std::vector<Face>& faces1, const std::vector<Face>& faces2, Function function)
+{
+	std::vector<Point3f> corners;
+	corners.reserve(3*faces2.size());
+	for(const Face& face : faces2)
+	{
+		corners.push_back(face.v1().getPosition());
+		corners.push_back(face.v2().getPosition());
+		corners.push_back(face.v3().getPosition());
+	}
+	TriangleTree tree(corners);
+	if(tree.getNumNodes()==0)
+	{
+		return;
+	}
+
+	std::atomic<bool> stop(false);
+	Parallel::forEach(0, faces1.size(), [&](int i)
+	{
+		const Face& face1 = faces1[i];
+		Bound bound1 = face1.getBound();
+		Point3f startPos, endPos;
+		int stack[64];
+		int top = 0;
+		stack[top++] = TriangleTree::ROOT;
+		while(top>0 && !stop)
+		{
+			const TriangleTree::Node& node = tree.getNode(stack[--top]);
+			if(!node.bound.overlap(bound1))
+			{
+				continue;
+			}
+			if(node.left>=0)
+			{
+				stack[top++] = node.left;
+				stack[top++] = node.right;
+				continue;
+			}
+			for(int j=node.begin;j<node.end && !stop;j++)
+			{
+				const Face& face2 = faces2[tree.getTriangle(j)];
+				if(bound1.overlap(face2.getBound()) && Object3D::intersectFaces(face1, face2, startPos, endPos) && !function(i, startPos, endPos))
+				{
+					stop = true;
+				}
+			}
+		}
+	}, 16);
+}
+
+//---------------------------------CONSTRUCTORS---------------------------------//
+
+/**
+ * Computes the curves where the surfaces of two solids meet
+ *
+ * @param solid1 first solid
+ * @param solid2 second solid
+ */
+IntersectionCurves::IntersectionCurves(const Solid& solid1, const Solid& solid2)
+{
+	TRACE_SCOPE("IntersectionCurves::IntersectionCurves");
+	if(solid1.isEmpty() || solid2.isEmpty() || !solid1.getBound().overlap(solid2.getBound()))
+	{
+		return;
+	}
+
+	//faces of both solids, without the vertex merging of Object3D as nothing is split
+	std::vector<Vertex> vertices1, vertices2;
+	std::vector<Face> faces1, faces2;
+	getFaces(solid1, vertices1, faces1);
+	getFaces(solid2, vertices2, faces2);
+
+	//segments of each face of the first solid, two ends each
+	std::vector<std::vector<Point3f>> segments(faces1.size());
+	forEachCrossing(faces1, faces2, [&](int face1, const Point3f& startPos, const Point3f& endPos)
+	{
+		segments[face1].push_back(startPos);
+		segments[face1].push_back(endPos);
+		return true;
+	});
+
+	std::vector<Point3f> ends;
+	for(const std::vector<Point3f>& faceSegments : segments)
+	{
+		ends.insert(ends.end(), faceSegments.begin(), faceSegments.end());
+	}
+	chainSegments(ends);
+}
+
+//-------------------------------------GETS-------------------------------------//
+
+/**
+ * Gets the number of curves
+ *
+ * @return number of curves
+ */
+int IntersectionCurves::getNumCurves() const
+{
+	return curves.size();
+}
+
+/**
+ * Gets the points of a curve
+ *
+ * @param index curve position
+ * @return polyline points, the first one not repeated at the end of closed curves
+ */
+const std::vector<Point3f>& IntersectionCurves::getCurve(int index) const
+{
+	return curves[index];
+}
+
+/**
+ * Checks if a curve goes back to its first point
+ *
+ * @param index curve position
+ * @return true if the curve is closed
+ */
+bool IntersectionCurves::isClosed(int index) const
+{
+	return closed[index];
+}
+
+/**
+ * Gets the number of distinct segments the curves are made of
+ *
+ * @return number of segments
+ */
+int IntersectionCurves::getNumSegments() const
+{
+	return numSegments;
+}
+
+/**
+ * Gets the total length of the curves
+ *
+ * @return sum of the segment lengths
+ */
+double IntersectionCurves::getLength() const
+{
+	double length = 0;
+	for(size_t i=0;i<curves.size();i++)
+	{
+		for(size_t j=1;j<curves[i].size();j++)
+		{
+			length += curves[i][j-1].distance(curves[i][j]);
+		}
+		if(closed[i])
+		{
+			length += curves[i].back().distance(curves[i].front());
+		}
+	}
+	return length;
+}
+
+/**
+ * Checks if the surfaces of two solids cross each other, stopping at the first pair
+ * of crossing triangles
+ *
+ * @param solid1 first solid
+ * @param solid2 second solid
+ * @return true if some triangles cross (or touch)
+ */
+bool IntersectionCurves::crosses(const Solid& solid1, const Solid& solid2)
+{
+	TRACE_SCOPE("IntersectionCurves::crosses");
+	if(solid1.isEmpty() || solid2.isEmpty() || !solid1.getBound().overlap(solid2.getBound()))
+	{
+		return false;
+	}
+
+	std::vector<Vertex> vertices1, vertices2;
+	std::vector<Face> faces1, faces2;
+	getFaces(solid1, vertices1, faces1);
+	getFaces(solid2, vertices2, faces2);
+	std::atomic<bool> found(false);
+	forEachCrossing(faces1, faces2, [&](int, const Point3f&, const Point3f&)
+	{
+		found = true;
+		return false;
+	});
+	return found;
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/**
+ * Makes a face for every triangle of a solid
+ *
+ * @param solid solid to read
+ * @param vertices output, one vertex per solid vertex
+ * @param faces output, one face per solid triangle
+ */
+void IntersectionCurves::getFaces(const Solid& solid, std::vector<Vertex>& vertices, std::vector<Face>& faces)
+{
+	const std::vector<Point3f>& positions = solid.getVertices();
+	const std::vector<int>& indices = solid.getIndices();
+	const std::vector<Colour3f>& colors = solid.getColors();
+	vertices.reserve(positions.size());
+	for(size_t i=0;i<positions.size();i++)
+	{
+		vertices.push_back(Vertex(vertices, positions[i], colors[i]));
+	}
+	faces.reserve(indices.size()/3);
+	for(size_t i=0;i+2<indices.size();i+=3)
+	{
+		faces.push_back(Face(vertices, indices[i], indices[i+1], indices[i+2]));
+	}
+}
+
+/**
+ * Merges the close segment ends and chains the segments into curves. A curve stops
+ * at points where other than two segments meet, and what is left is made of loops.
+ *
+ * @param ends segment ends, two per segment
+ */
+void IntersectionCurves::chainSegments(const std::vector<Point3f>& ends)
+{
+	//merge the ends through a grid of cells as wide as the tolerance
+	std::vector<Point3f> points;
+	std::map<std::array<long long,3>, std::vector<int>> cells;
+	std::vector<int> pointOf(ends.size());
+	for(size_t i=0;i<ends.size();i++)
+	{
+		const Point3f& end = ends[i];
+		std::array<long long,3> cell = {(long long)std::floor(end.x/TOL), (long long)std::floor(end.y/TOL), (long long)std::floor(end.z/TOL)};
+		int found = -1;
+		for(int dx=-1;dx<=1 && found<0;dx++)
+		{
+			for(int dy=-1;dy<=1 && found<0;dy++)
+			{
+				for(int dz=-1;dz<=1 && found<0;dz++)
+				{
+					auto it = cells.find({cell[0]+dx, cell[1]+dy, cell[2]+dz});
+					if(it==cells.end())
+					{
+						continue;
+					}
+					for(int point : it->second)
+					{
+						if(std::abs(points[point].x-end.x)<TOL && std::abs(points[point].y-end.y)<TOL && std::abs(points[point].z-end.z)<TOL)
+						{
+							found = point;
+							break;
+						}
+					}
+				}
+			}
+		}
+		if(found<0)
+		{
+			found = points.size();
+			points.push_back(end);
+			cells[cell].push_back(found);
+		}
+		pointOf[i] = found;
+	}
+
+	//distinct segments: the same one comes from every face pair sharing it
+	std::set<std::pair<int,int>> unique;
+	std::vector<std::pair<int,int>> edges;
+	std::vector<std::vector<int>> adjacency(points.size());
+	for(size_t i=0;i<ends.size();i+=2)
+	{
+		int a = pointOf[i];
+		int b = pointOf[i+1];
+		if(a!=b && unique.insert({std::min(a,b), std::max(a,b)}).second)
+		{
+			adjacency[a].push_back(edges.size());
+			adjacency[b].push_back(edges.size());
+			edges.push_back({a, b});
+		}
+	}
+	numSegments = edges.size();
+
+	//follows the unused edges from a point until a point not joining exactly two
+	std::vector<char> used(edges.size(), 0);
+	auto follow = [&](int start, int edge)
+	{
+		std::vector<int> curve(1, start);
+		int point = start;
+		while(edge>=0)
+		{
+			used[edge] = 1;
+			point = edges[edge].first==point ? edges[edge].second : edges[edge].first;
+			if(point==start)
+			{
+				closed.push_back(1);
+				break;
+			}
+			curve.push_back(point);
+			edge = -1;
+			if(adjacency[point].size()==2)
+			{
+				for(int next : adjacency[point])
+				{
+					if(!used[next])
+					{
+						edge = next;
+					}
+				}
+			}
+			if(edge<0)
+			{
+				closed.push_back(0);
+			}
+		}
+		curves.push_back(std::vector<Point3f>());
+		for(int index : curve)
+		{
+			curves.back().push_back(points[index]);
+		}
+	};
+
+	for(size_t i=0;i<points.size();i++)
+	{
+		if(adjacency[i].size()!=2)
+		{
+			for(int edge : adjacency[i])
+			{
+				if(!used[edge])
+				{
+					follow(i, edge);
+				}
+			}
+		}
+	}
+	for(size_t i=0;i<edges.size();i++)
+	{
+		if(!used[i])
+		{
+			follow(edges[i].first, i);
+		}
+	}
+}
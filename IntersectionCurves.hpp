@@ -0,0 +1,59 @@
+#ifndef __INTERSECTION_CURVES__
+#define __INTERSECTION_CURVES__
+
+#include<vector>
+#include"Point3f.hpp"
+
+class Solid;
+class Vertex;
+class Face;
+
+/**
+ * Curves where the surfaces of two solids meet.
+ *
+ * <br><br>Every pair of crossing triangles gives a segment, computed as in the face
+ * splitting of a bool operation (see Object3D::intersectFaces), but no face is split
+ * or classified. The pairs are found through a hierarchy over the triangles of the
+ * second solid. The segment ends closer than the Vertex tolerance are merged and the
+ * segments are chained into polylines, which stop where the curve ends or branches.
+ *
+ * <br><br>crosses() only tells whether there is any such pair, and stops at the first.
+ *
+ * @author akatsia-games on github.com
+ */
+class IntersectionCurves
+{
+public:
+	IntersectionCurves(const Solid& solid1, const Solid& solid2);
+
+	int getNumCurves() const;
+
+	const std::vector<Point3f>& getCurve(int index) const;
+
+	bool isClosed(int index) const;
+
+	int getNumSegments() const;
+
+	double getLength() const;
+
+	static bool crosses(const Solid& solid1, const Solid& solid2);
+
+private:
+	template<typename Function>
+	static void forEachCrossing(const std::vector<Face>& faces1, const std::vector<Face>& faces2, Function function);
+
+	static void getFaces(const Solid& solid, std::vector<Vertex>& vertices, std::vector<Face>& faces);
+
+	void chainSegments(const std::vector<Point3f>& ends);
+
+	/** polyline points of each curve, the first one not repeated on closed curves */
+	std::vector<std::vector<Point3f>> curves;
+	/** true for the curves going back to their first point */
+	std::vector<char> closed;
+	/** number of distinct segments the curves are made of */
+	int numSegments = 0;
+
+	/** distance (on each coordinate) under which two segment ends are the same, as in Vertex */
+	constexpr static const double TOL = 1e-5;
+};
+#endif //__INTERSECTION_CURVES__
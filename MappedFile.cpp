@@ -0,0 +1,138 @@
+#include "MappedFile.hpp"
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_MMAP
+#endif
+
+/**
+ * Read only view of a whole file, mapped in memory when the platform allows it.
+ * 
+ * @author akatsia-games on github.com
+ */
+
+//---------------------------------CONSTRUCTORS---------------------------------//
+
+/**
+ * Opens and maps a file. Use isOpen() to check if it succeeded.
+ * 
+ * @param path file path
+ */
+MappedFile::MappedFile(const std::string& path)
+	:data(nullptr)
+	,size(0)
+	,mapped(false)
+{
+#ifdef MAPPED_FILE_MMAP
+	int descriptor = open(path.c_str(), O_RDONLY);
+	if(descriptor<0)
+	{
+		return;
+	}
+	struct stat status;
+	if(fstat(descriptor, &status)==0)
+	{
+		size = status.st_size;
+		if(size==0)
+		{
+			data = "";
+		}
+		else
+		{
+			void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+			if(address!=MAP_FAILED)
+			{
+				madvise(address, size, MADV_SEQUENTIAL);
+				data = (const char*)address;
+				mapped = true;
+			}
+		}
+	}
+	close(descriptor);
+	if(data!=nullptr)
+	{
+		return;
+	}
+	size = 0;
+#endif
+	//no mmap available: read the whole file
+	std::ifstream file(path, std::ios::binary|std::ios::ate);
+	if(!file)
+	{
+		return;
+	}
+	buffer.resize(file.tellg());
+	file.seekg(0);
+	if(file.read(buffer.data(), buffer.size()))
+	{
+		data = buffer.empty() ? "" : buffer.data();
+		size = buffer.size();
+	}
+}
+
+/**
+ * Takes over the mapping of another MappedFile
+ * 
+ * @param other mapped file left closed
+ */
+MappedFile::MappedFile(MappedFile&& other)
+	:data(other.data)
+	,size(other.size)
+	,mapped(other.mapped)
+	,buffer(std::move(other.buffer))
+{
+	if(!mapped && data!=nullptr && size>0)
+	{
+		data = buffer.data();
+	}
+	other.data = nullptr;
+	other.size = 0;
+	other.mapped = false;
+}
+
+/** Releases the mapping */
+MappedFile::~MappedFile()
+{
+#ifdef MAPPED_FILE_MMAP
+	if(mapped)
+	{
+		munmap((void*)data, size);
+	}
+#endif
+}
+
+//-------------------------------------GETS-------------------------------------//
+
+/**
+ * Checks if the file could be opened
+ * 
+ * @return true if the file contents are available, false otherwise
+ */
+bool MappedFile::isOpen() const
+{
+	return data!=nullptr;
+}
+
+/**
+ * Gets the file contents
+ * 
+ * @return first byte of the file
+ */
+const char* MappedFile::getData() const
+{
+	return data;
+}
+
+/**
+ * Gets the file size
+ * 
+ * @return file size in bytes
+ */
+size_t MappedFile::getSize() const
+{
+	return size;
+}
@@ -0,0 +1,45 @@
+#ifndef __MAPPED_FILE__
+#define __MAPPED_FILE__
+
+#include<string>
+#include<vector>
+#include<cstddef>
+
+/**
+ * Read only view of a whole file, mapped in memory when the platform allows it.
+ * 
+ * <br><br>On platforms without mmap the file is read into an internal buffer, so the
+ * users always see a contiguous block of bytes.
+ * 
+ * @author akatsia-games on github.com
+ */
+class MappedFile
+{
+public:
+	MappedFile(const std::string& path);
+
+	MappedFile(MappedFile&& other);
+
+	MappedFile(const MappedFile& other) = delete;
+
+	MappedFile& operator=(const MappedFile& other) = delete;
+
+	~MappedFile();
+
+	bool isOpen() const;
+
+	const char* getData() const;
+
+	size_t getSize() const;
+
+private:
+	/** first byte of the file, null if it couldn't be opened */
+	const char* data;
+	/** file size in bytes */
+	size_t size;
+	/** true if data points to a memory mapping that must be released */
+	bool mapped;
+	/** file contents when it couldn't be mapped */
+	std::vector<char> buffer;
+};
+#endif //__MAPPED_FILE__
@@ -0,0 +1,130 @@
+#ifndef __MASS_PROPERTIES__
+#define __MASS_PROPERTIES__
+
+#include<cmath>
+#include"Point3f.hpp"
+
+/**
+ * Volume integrals of a solid given by its boundary triangles: volume, centroid and
+ * inertia tensor, for a unit density.
+ *
+ * <br><br>Each triangle adds the signed tetrahedron it makes with a reference point,
+ * as Solid::getVolume does with the origin. The reference point should be near the
+ * solid, to keep the products from cancelling out.
+ *
+ * <br><br>See: F. Tonon. "Explicit Exact Formulas for the 3-D Tetrahedron Inertia
+ * Tensor in Terms of its Vertex Coordinates", Journal of Mathematics and Statistics, 2004.
+ *
+ * @author akatsia-games on github.com
+ */
+class MassProperties
+{
+public:
+	/** point the integrals are taken from */
+	Point3f reference;
+	/** signed volume (positive for outwards facing triangles) */
+	double volume = 0;
+	/** integrals of x, y and z over the volume, from the reference point */
+	double moments[3] = {};
+	/** integrals of xx, yy, zz, xy, yz and zx over the volume, from the reference point */
+	double products[6] = {};
+
+	/**
+	 * Constructs empty integrals
+	 *
+	 * @param reference point the integrals are taken from
+	 */
+	MassProperties(const Point3f& reference = Point3f())
+		:reference(reference)
+	{
+	}
+
+	/**
+	 * Adds the tetrahedron made by a triangle and the reference point
+	 *
+	 * @param p1 first triangle corner
+	 * @param p2 second triangle corner
+	 * @param p3 third triangle corner
+	 */
+	void addTriangle(const Point3f& p1, const Point3f& p2, const Point3f& p3)
+	{
+		double a[3] = {p1.x-reference.x, p1.y-reference.y, p1.z-reference.z};
+		double b[3] = {p2.x-reference.x, p2.y-reference.y, p2.z-reference.z};
+		double c[3] = {p3.x-reference.x, p3.y-reference.y, p3.z-reference.z};
+		double determinant = a[0]*(b[1]*c[2]-b[2]*c[1])+a[1]*(b[2]*c[0]-b[0]*c[2])+a[2]*(b[0]*c[1]-b[1]*c[0]);
+		double sum[3] = {a[0]+b[0]+c[0], a[1]+b[1]+c[1], a[2]+b[2]+c[2]};
+		volume += determinant/6;
+		for(int i=0;i<3;i++)
+		{
+			moments[i] += determinant*sum[i]/24;
+		}
+		static const int first[6] = {0, 1, 2, 0, 1, 2};
+		static const int second[6] = {0, 1, 2, 1, 2, 0};
+		for(int k=0;k<6;k++)
+		{
+			int i = first[k];
+			int j = second[k];
+			products[k] += determinant*(a[i]*a[j]+b[i]*b[j]+c[i]*c[j]+sum[i]*sum[j])/120;
+		}
+	}
+
+	/**
+	 * Adds the integrals of other triangles, taken from the same reference point
+	 *
+	 * @param other integrals to add
+	 */
+	void add(const MassProperties& other)
+	{
+		volume += other.volume;
+		for(int i=0;i<3;i++)
+		{
+			moments[i] += other.moments[i];
+		}
+		for(int i=0;i<6;i++)
+		{
+			products[i] += other.products[i];
+		}
+	}
+
+	/**
+	 * Gets the centroid
+	 *
+	 * @return centroid, with NAN coordinates if the volume is 0
+	 */
+	Point3f getCentroid() const
+	{
+		if(volume==0)
+		{
+			return Point3f(NAN, NAN, NAN);
+		}
+		return Point3f(reference.x+moments[0]/volume, reference.y+moments[1]/volume, reference.z+moments[2]/volume);
+	}
+
+	/**
+	 * Gets the inertia tensor about the centroid
+	 *
+	 * @param inertia output, symmetric tensor (all 0 if the volume is 0)
+	 */
+	void getInertia(double inertia[3][3]) const
+	{
+		//second moments about the centroid
+		double central[3][3] = {};
+		static const int first[6] = {0, 1, 2, 0, 1, 2};
+		static const int second[6] = {0, 1, 2, 1, 2, 0};
+		for(int k=0;k<6;k++)
+		{
+			int i = first[k];
+			int j = second[k];
+			central[i][j] = central[j][i] = volume==0 ? 0 : products[k]-moments[i]*moments[j]/volume;
+		}
+		double trace = central[0][0]+central[1][1]+central[2][2];
+		for(int i=0;i<3;i++)
+		{
+			for(int j=0;j<3;j++)
+			{
+				inertia[i][j] = (i==j ? trace : 0)-central[i][j];
+			}
+		}
+	}
+};
+#endif //__MASS_PROPERTIES__
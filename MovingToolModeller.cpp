@@ -0,0 +1,241 @@
+#include "MovingToolModeller.hpp"
+#include "BooleanModeller.hpp"
+#include "TriangleTree.hpp"
+#include "Trace.hpp"
+#include "VertexWelder.hpp"
+#include <algorithm>
+
+/**
+ * Difference of a fixed workpiece and a tool moving from frame to frame.
+ *
+ * @author akatsia-games on github.com
+ */
+
+//---------------------------------CONSTRUCTORS---------------------------------//
+
+/**
+ * Constructs a modeller for a workpiece and a tool, placed as given
+ *
+ * @param workpiece solid the tool is substracted from
+ * @param tool solid substracted, moved by setToolTransform
+ */
+MovingToolModeller::MovingToolModeller(const Solid& workpiece, const Solid& tool)
+	:workpiece(workpiece)
+	,tool(tool)
+	,workpieceWinding(workpiece)
+{
+	const double identity[4][4] = {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}};
+	setToolTransform(identity);
+}
+
+//-------------------------------------SETS-------------------------------------//
+
+/**
+ * Places the tool for a new frame, splitting and classifying the workpiece faces near
+ * it and the tool faces
+ *
+ * @param matrix affine transform from the tool as given, whose last row must be 0 0 0 1
+ * @return false if the matrix isn't affine, in which case the frame is left as it was
+ */
+bool MovingToolModeller::setToolTransform(const double matrix[4][4])
+{
+	TRACE_SCOPE("MovingToolModeller::setToolTransform");
+	Solid placedTool = tool;
+	if(!placedTool.transform(matrix))
+	{
+		return false;
+	}
+	Bound toolBound = placedTool.getBound();
+
+	warmStarted = nearBound.contains(toolBound.getMin()) && nearBound.contains(toolBound.getMax());
+	if(!warmStarted)
+	{
+		gatherNearFaces(toolBound);
+	}
+
+	nearObject.reset();
+	toolObject.reset();
+	if(tool.isEmpty() || !toolBound.overlap(workpiece.getBound()))
+	{
+		return true;
+	}
+	nearObject.reset(new Object3D(nearSolid));
+	toolObject.reset(new Object3D(placedTool));
+	nearObject->splitFacesBatched(*toolObject);
+	toolObject->splitFacesBatched(*nearObject);
+
+	//the near faces are classified by the placed tool, the tool faces by the whole workpiece
+	WindingNumber toolWinding(*toolObject);
+	nearObject->classifyFaces(toolWinding);
+	toolObject->classifyFaces(workpieceWinding);
+	return true;
+}
+
+//-------------------------------------GETS-------------------------------------//
+
+/**
+ * Gets the workpiece minus the tool, as placed for the current frame
+ *
+ * @return workpiece minus the tool
+ */
+Solid MovingToolModeller::getDifference() const
+{
+	TRACE_SCOPE("MovingToolModeller::getDifference");
+	std::vector<Point3f> vertices = farVertices;
+	std::vector<Colour3f> colors = farColors;
+	std::vector<int> indices = farIndices;
+
+	//the near faces are welded to the seam of the far faces and to each other
+	VertexWelder welder(vertices, colors);
+	for(int vertex : seamVertices)
+	{
+		welder.addVertex(vertex);
+	}
+
+	if(!nearObject)
+	{
+		//the tool is away from the workpiece, so the near faces pass as they are
+		const std::vector<Point3f>& nearVertices = nearSolid.getVertices();
+		const std::vector<Colour3f>& nearColors = nearSolid.getColors();
+		std::vector<int> weldedOf(nearVertices.size(), -1);
+		for(int index : nearSolid.getIndices())
+		{
+			int& welded = weldedOf[index];
+			if(welded<0)
+			{
+				welded = welder.weld(nearVertices[index], nearColors[index]);
+			}
+			indices.push_back(welded);
+		}
+	}
+	else
+	{
+		for(int objectNumber=0;objectNumber<2;objectNumber++)
+		{
+			const Object3D& object = objectNumber==0 ? *nearObject : *toolObject;
+			std::vector<int> weldedOf(object.getNumVertices(), -1);
+			for(int i=0;i<object.getNumFaces();i++)
+			{
+				const Face& face = object.getFace(i);
+				int orientation = BooleanModeller::getFaceOrientation(BooleanModeller::DIFFERENCE, objectNumber==0, face.getStatus());
+				if(orientation==0)
+				{
+					continue;
+				}
+				int welded[3];
+				welder.weldFace(face, orientation, weldedOf, welded);
+				indices.insert(indices.end(), welded, welded+3);
+			}
+		}
+	}
+
+	Solid difference;
+	difference.setData(std::move(vertices), std::move(indices), std::move(colors));
+	return difference;
+}
+
+/**
+ * Gets the number of workpiece faces split and classified on each frame
+ *
+ * @return number of near faces
+ */
+int MovingToolModeller::getNumNearFaces() const
+{
+	return nearSolid.getIndices().size()/3;
+}
+
+/**
+ * Checks if the current frame reused the near faces of the previous one
+ *
+ * @return true if the near faces weren't gathered again
+ */
+bool MovingToolModeller::isWarmStarted() const
+{
+	return warmStarted;
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/**
+ * Gathers the workpiece triangles near the tool through the hierarchy of the winding
+ * number, and splits the workpiece into those and the ones passing to the results
+ *
+ * @param toolBound bound of the placed tool
+ */
+void MovingToolModeller::gatherNearFaces(const Bound& toolBound)
+{
+	TRACE_SCOPE("MovingToolModeller::gatherNearFaces");
+	Point3f min = toolBound.getMin();
+	Point3f max = toolBound.getMax();
+	double margin = NEAR_MARGIN*std::max(max.x-min.x, std::max(max.y-min.y, max.z-min.z));
+	nearBound = Bound(std::vector<Point3f>{Point3f(min.x-margin, min.y-margin, min.z-margin), Point3f(max.x+margin, max.y+margin, max.z+margin)});
+
+	const std::vector<Point3f>& positions = workpiece.getVertices();
+	const std::vector<int>& indices = workpiece.getIndices();
+	const std::vector<Colour3f>& colors = workpiece.getColors();
+	std::vector<char> near(indices.size()/3, 0);
+	const TriangleTree& tree = workpieceWinding.getTree();
+	if(tree.getNumNodes()>0)
+	{
+		int stack[64];
+		int top = 0;
+		stack[top++] = TriangleTree::ROOT;
+		while(top>0)
+		{
+			const TriangleTree::Node& node = tree.getNode(stack[--top]);
+			if(!node.bound.overlap(nearBound))
+			{
+				continue;
+			}
+			if(node.left>=0)
+			{
+				stack[top++] = node.left;
+				stack[top++] = node.right;
+				continue;
+			}
+			for(int i=node.begin;i<node.end;i++)
+			{
+				int triangle = tree.getTriangle(i);
+				near[triangle] = Bound(tree.getCorner(triangle,0), tree.getCorner(triangle,1), tree.getCorner(triangle,2)).overlap(nearBound);
+			}
+		}
+	}
+
+	//each workpiece vertex goes to the near solid, the far vertices, or both if on the seam
+	std::vector<int> nearVertexOf(positions.size(), -1);
+	std::vector<int> farVertexOf(positions.size(), -1);
+	std::vector<Point3f> nearVertices;
+	std::vector<Colour3f> nearColors;
+	std::vector<int> nearIndices;
+	farVertices.clear();
+	farColors.clear();
+	farIndices.clear();
+	seamVertices.clear();
+	for(size_t i=0;i+2<indices.size();i+=3)
+	{
+		bool isNear = near[i/3];
+		std::vector<int>& vertexOf = isNear ? nearVertexOf : farVertexOf;
+		std::vector<Point3f>& vertices = isNear ? nearVertices : farVertices;
+		std::vector<Colour3f>& vertexColors = isNear ? nearColors : farColors;
+		std::vector<int>& triangles = isNear ? nearIndices : farIndices;
+		for(int corner=0;corner<3;corner++)
+		{
+			int index = indices[i+corner];
+			if(vertexOf[index]<0)
+			{
+				vertexOf[index] = vertices.size();
+				vertices.push_back(positions[index]);
+				vertexColors.push_back(colors[index]);
+			}
+			triangles.push_back(vertexOf[index]);
+		}
+	}
+	for(size_t i=0;i<positions.size();i++)
+	{
+		if(nearVertexOf[i]>=0 && farVertexOf[i]>=0)
+		{
+			seamVertices.push_back(farVertexOf[i]);
+		}
+	}
+	nearSolid.setData(std::move(nearVertices), std::move(nearIndices), std::move(nearColors));
+}
@@ -0,0 +1,69 @@
+#ifndef __MOVING_TOOL_MODELLER__
+#define __MOVING_TOOL_MODELLER__
+
+#include<memory>
+#include<vector>
+#include"Point3f.hpp"
+#include"Bound.hpp"
+#include"Solid.hpp"
+#include"Object3D.hpp"
+#include"WindingNumber.hpp"
+
+/**
+ * Difference of a fixed workpiece and a tool moving from frame to frame, as in a
+ * machining preview.
+ *
+ * <br><br>The workpiece is read once: its winding number classifies the tool faces of
+ * every frame, and the hierarchy under it finds the workpiece faces near the tool.
+ * Only those faces and the placed tool are split and classified each frame, as by a
+ * BooleanModeller with BATCHED_SPLIT and WINDING_NUMBER; the other workpiece faces are
+ * outside the tool and go to the result untouched.
+ *
+ * <br><br>The near faces are gathered for a bound larger than the tool (see
+ * NEAR_MARGIN), and reused by the following frames while the tool stays inside it.
+ *
+ * @author akatsia-games on github.com
+ */
+class MovingToolModeller
+{
+public:
+	MovingToolModeller(const Solid& workpiece, const Solid& tool);
+
+	bool setToolTransform(const double matrix[4][4]);
+
+	Solid getDifference() const;
+
+	int getNumNearFaces() const;
+
+	bool isWarmStarted() const;
+
+private:
+	void gatherNearFaces(const Bound& toolBound);
+
+	/** workpiece the tool is substracted from */
+	Solid workpiece;
+	/** tool as given, before the transform of the frame */
+	Solid tool;
+	/** winding number of the workpiece, whose hierarchy also finds the near faces */
+	WindingNumber workpieceWinding;
+	/** bound the near faces were gathered for (NAN coordinates before the first frame) */
+	Bound nearBound;
+	/** workpiece triangles whose bound overlaps the near bound */
+	Solid nearSolid;
+	/** vertices of the other workpiece triangles, which pass to the result as they are */
+	std::vector<Point3f> farVertices;
+	/** colors of the far vertices */
+	std::vector<Colour3f> farColors;
+	/** triangles away from the tool, indexing the far vertices */
+	std::vector<int> farIndices;
+	/** far vertices also used by near triangles, where the split part is welded back */
+	std::vector<int> seamVertices;
+	/** near workpiece faces and placed tool of the current frame, split and classified (null if the tool is away from the workpiece) */
+	std::unique_ptr<Object3D> nearObject, toolObject;
+	/** true if the current frame reused the near faces of the previous one */
+	bool warmStarted = false;
+
+	/** enlargement of the near bound around the tool bound, relative to its longest side */
+	constexpr static const double NEAR_MARGIN = 0.25;
+};
+#endif //__MOVING_TOOL_MODELLER__
@@ -0,0 +1,299 @@
+#include "ObjFile.hpp"
+#include "MappedFile.hpp"
+#include "Parallel.hpp"
+#include "Solid.hpp"
+#include "Trace.hpp"
+#include <charconv>
+#include <cstring>
+
+/**
+ * Reader and writer for Wavefront OBJ files.
+ * 
+ * @author akatsia-games on github.com
+ */
+
+//---------------------------------------READ-----------------------------------//
+
+/**
+ * Loads an OBJ file into a solid
+ * 
+ * @param path file path
+ * @param solid solid receiving the data
+ * @param color color of the vertices without one
+ * @return true if the file was read, false if it couldn't be opened or is malformed
+ */
+bool ObjFile::load(const std::string& path, Solid& solid, Colour3f color)
+{
+	TRACE_SCOPE("ObjFile::load");
+	MappedFile file(path);
+	if(!file.isOpen())
+	{
+		return false;
+	}
+	return parse(file.getData(), file.getData()+file.getSize(), solid, color);
+}
+
+/**
+ * Parses the contents of an OBJ file into a solid
+ * 
+ * @param begin first character of the file
+ * @param end one past the last character of the file
+ * @param solid solid receiving the data, left untouched if the contents are malformed
+ * @param color color of the vertices without one
+ * @return true if the contents were read, false if they are malformed
+ */
+bool ObjFile::parse(const char* begin, const char* end, Solid& solid, Colour3f color)
+{
+	TRACE_SCOPE("ObjFile::parse");
+	//split the file in chunks of whole lines
+	int numChunks = 1;
+	if((size_t)(end-begin)>PARALLEL_SIZE)
+	{
+		numChunks = Parallel::getNumThreads()*CHUNKS_PER_THREAD;
+	}
+	std::vector<const char*> bounds(numChunks+1);
+	bounds[0] = begin;
+	bounds[numChunks] = end;
+	for(int i=1;i<numChunks;i++)
+	{
+		const char* bound = std::max(begin + (end-begin)*(long long)i/numChunks, bounds[i-1]);
+		const char* lineEnd = (const char*)memchr(bound, '\n', end-bound);
+		bounds[i] = (lineEnd==nullptr) ? end : lineEnd+1;
+	}
+	
+	std::vector<Chunk> chunks(numChunks);
+	Parallel::forEach(0, numChunks, [&bounds, &chunks, color](int i)
+	{
+		parseChunk(bounds[i], bounds[i+1], color, chunks[i]);
+	}, 1);
+	
+	//the vertex counts of the previous chunks resolve the relative indices
+	std::vector<int> firstVertex(numChunks+1, 0);
+	std::vector<size_t> firstCorner(numChunks+1, 0);
+	for(int i=0;i<numChunks;i++)
+	{
+		if(!chunks[i].valid)
+		{
+			return false;
+		}
+		firstVertex[i+1] = firstVertex[i]+chunks[i].vertices.size();
+		firstCorner[i+1] = firstCorner[i]+chunks[i].corners.size();
+	}
+	
+	int numVertices = firstVertex[numChunks];
+	std::vector<Point3f> vertices(numVertices);
+	std::vector<Colour3f> colors(numVertices);
+	std::vector<int> indices(firstCorner[numChunks]);
+	std::vector<char> valid(numChunks, true);
+	Parallel::forEach(0, numChunks, [&](int i)
+	{
+		Chunk& chunk = chunks[i];
+		std::copy(chunk.vertices.begin(), chunk.vertices.end(), vertices.begin()+firstVertex[i]);
+		std::copy(chunk.colors.begin(), chunk.colors.end(), colors.begin()+firstVertex[i]);
+		for(size_t j=0;j<chunk.corners.size();j++)
+		{
+			long long corner = chunk.corners[j];
+			long long index = (corner>=0) ? corner : firstVertex[i]+(corner-RELATIVE);
+			if(index<0 || index>=numVertices)
+			{
+				valid[i] = false;
+			}
+			indices[firstCorner[i]+j] = index;
+		}
+	}, 1);
+	for(char chunkValid : valid)
+	{
+		if(!chunkValid)
+		{
+			return false;
+		}
+	}
+	
+	solid.setData(std::move(vertices), std::move(indices), std::move(colors));
+	return true;
+}
+
+//--------------------------------------WRITE-----------------------------------//
+
+/**
+ * Writes a solid as an OBJ file, with the vertex colors as "v x y z r g b" lines. 
+ * Coordinates are written with the shortest representation that reads back exactly.
+ * 
+ * @param solid solid to be written
+ * @param objFile stream
+ */
+void ObjFile::write(const Solid& solid, std::basic_ostream<char>& objFile)
+{
+	TRACE_SCOPE("ObjFile::write");
+	const std::vector<Point3f>& vertices = solid.getVertices();
+	const std::vector<int>& indices = solid.getIndices();
+	const std::vector<Colour3f>& colors = solid.getColors();
+	bool hasColors = colors.size()==vertices.size();
+	
+	std::string chunk;
+	char number[32];
+	auto flush = [&chunk, &objFile]()
+	{
+		if(chunk.size()>(1<<16))
+		{
+			objFile.write(chunk.data(), chunk.size());
+			chunk.clear();
+		}
+	};
+	
+	for(size_t i=0;i<vertices.size();i++)
+	{
+		chunk += 'v';
+		double values[6] = {vertices[i].x, vertices[i].y, vertices[i].z};
+		if(hasColors)
+		{
+			values[3] = colors[i].r;
+			values[4] = colors[i].g;
+			values[5] = colors[i].b;
+		}
+		for(int j=0;j<(hasColors ? 6 : 3);j++)
+		{
+			chunk += ' ';
+			chunk.append(number, std::to_chars(number, number+sizeof(number), values[j]).ptr);
+		}
+		chunk += '\n';
+		flush();
+	}
+	
+	for(size_t i=0;i+2<indices.size();i+=3)
+	{
+		chunk += 'f';
+		for(int j=0;j<3;j++)
+		{
+			chunk += ' ';
+			chunk.append(number, std::to_chars(number, number+sizeof(number), indices[i+j]+1).ptr);
+		}
+		chunk += '\n';
+		flush();
+	}
+	objFile.write(chunk.data(), chunk.size());
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/**
+ * Parses the lines of a chunk
+ * 
+ * @param begin first character of the chunk (start of a line)
+ * @param end one past the last character of the chunk (start of a line or end of file)
+ * @param color color of the vertices without one
+ * @param chunk arrays receiving the data
+ */
+void ObjFile::parseChunk(const char* begin, const char* end, Colour3f color, Chunk& chunk)
+{
+	chunk.valid = true;
+	auto isSpace = [](char character){ return character==' ' || character=='\t' || character=='\r'; };
+	
+	std::vector<long long> polygon;
+	for(const char* line=begin;line<end;)
+	{
+		const char* lineEnd = (const char*)memchr(line, '\n', end-line);
+		if(lineEnd==nullptr)
+		{
+			lineEnd = end;
+		}
+		const char* position = line;
+		line = lineEnd+1;
+		
+		while(position<lineEnd && isSpace(*position))
+		{
+			position++;
+		}
+		if(lineEnd-position<2 || !isSpace(position[1]) || (position[0]!='v' && position[0]!='f'))
+		{
+			continue;
+		}
+		bool isVertex = position[0]=='v';
+		position += 2;
+		
+		//read the numbers of the line
+		double values[6] = {};
+		int numValues = 0;
+		polygon.clear();
+		while(true)
+		{
+			while(position<lineEnd && isSpace(*position))
+			{
+				position++;
+			}
+			if(position>=lineEnd || *position=='#')
+			{
+				break;
+			}
+			if(*position=='+')
+			{
+				position++;
+			}
+			
+			std::from_chars_result result;
+			if(isVertex)
+			{
+				double value = 0;
+				result = std::from_chars(position, lineEnd, value);
+				if(result.ec==std::errc() && numValues<6)
+				{
+					values[numValues++] = value;
+				}
+			}
+			else
+			{
+				//"v/vt/vn": only the vertex index is used
+				int value = 0;
+				result = std::from_chars(position, lineEnd, value);
+				if(result.ec!=std::errc())
+				{
+					chunk.valid = false;
+					return;
+				}
+				if(value>0)
+				{
+					polygon.push_back(value-1);
+				}
+				else if(value<0)
+				{
+					polygon.push_back(RELATIVE+(long long)chunk.vertices.size()+value);
+				}
+				else
+				{
+					result.ec = std::errc::invalid_argument;
+				}
+				while(result.ptr<lineEnd && !isSpace(*result.ptr))
+				{
+					result.ptr++;
+				}
+			}
+			if(result.ec!=std::errc())
+			{
+				chunk.valid = false;
+				return;
+			}
+			position = result.ptr;
+		}
+		
+		if(isVertex)
+		{
+			if(numValues<3)
+			{
+				chunk.valid = false;
+				return;
+			}
+			chunk.vertices.push_back({values[0], values[1], values[2]});
+			chunk.colors.push_back(numValues==6 ? Colour3f{values[3], values[4], values[5]} : color);
+		}
+		else
+		{
+			//triangle fan
+			for(size_t i=2;i<polygon.size();i++)
+			{
+				chunk.corners.push_back(polygon[0]);
+				chunk.corners.push_back(polygon[i-1]);
+				chunk.corners.push_back(polygon[i]);
+			}
+		}
+	}
+}
@@ -0,0 +1,54 @@
+#ifndef __OBJ_FILE__
+#define __OBJ_FILE__
+
+#include<iostream>
+#include<string>
+#include<vector>
+#include"Point3f.hpp"
+
+class Solid;
+
+/**
+ * Reader and writer for Wavefront OBJ files.
+ * 
+ * <br><br>Only the geometry is read: "v" lines, with the optional "r g b" vertex color
+ * extension mapped into the solid colors, and "f" lines, whose polygons are split in 
+ * triangle fans. Texture coordinates, normals, groups and materials are ignored.
+ * 
+ * <br><br>The file is mapped in memory and cut in chunks at line boundaries. Every 
+ * chunk is parsed in parallel into its own arrays; the chunks are then joined, also in
+ * parallel, once their vertex counts tell how to resolve the face indices.
+ * 
+ * @author akatsia-games on github.com
+ */
+class ObjFile
+{
+public:
+	static bool load(const std::string& path, Solid& solid, Colour3f color);
+
+	static bool parse(const char* begin, const char* end, Solid& solid, Colour3f color);
+
+	static void write(const Solid& solid, std::basic_ostream<char>& objFile);
+
+private:
+	/** data read from a chunk of the file */
+	struct Chunk
+	{
+		std::vector<Point3f> vertices;
+		std::vector<Colour3f> colors;
+		/** triangle corners: vertex index if not negative, else RELATIVE+(index inside the chunk) */
+		std::vector<long long> corners;
+		/** false if a malformed line was found */
+		bool valid;
+	};
+
+	static void parseChunk(const char* begin, const char* end, Colour3f color, Chunk& chunk);
+
+	/** offset of the corners given relative to the vertices of their chunk */
+	static const long long RELATIVE = -(1LL<<40);
+	/** files smaller than this are parsed by a single thread */
+	static const size_t PARALLEL_SIZE = 1<<20;
+	/** number of chunks given to each thread */
+	static const int CHUNKS_PER_THREAD = 4;
+};
+#endif //__OBJ_FILE__
@@ -1,4 +1,3 @@
-#define _DEBUG
 //#define _PREVENT_INFINITE
 
 #include"Object3D.hpp"
@@ -7,12 +6,24 @@
 #include"Point3f.hpp"
 #include"Face.hpp"
 #include"Segment.hpp"
+#include"WindingNumber.hpp"
+#include"Parallel.hpp"
+#include"Trace.hpp"
+#include"FaceSplitter.hpp"
+#include<array>
+#include<memory>
 
-
-#ifndef _DEBUG
-#define checkSplit(x,y)
+#ifdef UNBBOOLEAN_VALIDATE
+#include<iostream>
+#else
+#define checkSplit(x,y) ((void)(y))
 #endif
 
+#define REMOVE(faces, facepos)\
+int current_faces = faces.size();\
+faces[facepos] = faces.back();\
+faces.pop_back();
+
 
 std::vector<Vertex> Object3D::emptyVertices;
 Face Object3D::nullFace(Object3D::emptyVertices);
@@ -42,13 +53,18 @@ Face Object3D::nullFace(Object3D::emptyVertices);
 Object3D::Object3D(const Solid& solid)
 	:bound(solid.getVertices())
 {
+	TRACE_SCOPE("Object3D::Object3D");
+	double start = BooleanStatistics::getTime();
 	const std::vector<Point3f>& verticesPoints = solid.getVertices();
 	const std::vector<int>& indices = solid.getIndices();
 	const std::vector<Colour3f>& colors = solid.getColors();
 	std::vector<int> indexOfSolidVertices;
+	indexOfSolidVertices.reserve(verticesPoints.size());
+	trackAllocation(0);
 	
 	//create vertices
 	vertices.reserve(verticesPoints.size());
+	trackAllocation(0);
 	for(int i=0;i<verticesPoints.size();i++)
 	{
 		int idx = 0;
@@ -58,13 +74,16 @@ Object3D::Object3D(const Solid& solid)
 	
 	//create faces
 	faces.reserve(indices.size()/3); //indices.size / 3 rounded up
+	trackAllocation(indexOfSolidVertices.capacity()*sizeof(int));
 	for(int i=0; i<indices.size(); i=i+3)
 	{
 		int v1 = indexOfSolidVertices[indices[i]];
 		int v2 = indexOfSolidVertices[indices[i+1]];
 		int v3 = indexOfSolidVertices[indices[i+2]];
-		addFace(v1, v2, v3);
+		addFace(v1, v2, v3, 0, i/3);
 	}
+	endStage(indexOfSolidVertices.capacity()*sizeof(int));
+	statistics.stageTimes[BooleanStatistics::CONSTRUCT] = BooleanStatistics::getTime()-start;
 }
 
 //-----------------------------------OVERRIDES----------------------------------//
@@ -78,6 +97,9 @@ Object3D::Object3D(const Object3D& other)
 	:vertices(other.vertices)
 	,faces(other.faces)
 	,bound(other.bound)
+	,statistics(other.statistics)
+	,stage(other.stage)
+	,adjacencyBytes(other.adjacencyBytes)
 {
 }
 
@@ -93,6 +115,16 @@ int Object3D::getNumFaces() const
 	return faces.size();
 }
 
+/**
+ * Gets the number of vertices
+ * 
+ * @return number of vertices
+ */
+int Object3D::getNumVertices() const
+{
+	return vertices.size();
+}
+
 /**
  * Gets a face reference for a given position
  * 
@@ -139,6 +171,16 @@ const Bound& Object3D::getBound()const
 	return bound;
 }
 
+/**
+ * Gets the counters and stage times of the work done on this object
+ * 
+ * @return object statistics
+ */
+const BooleanStatistics& Object3D::getStatistics() const
+{
+	return statistics;
+}
+
 //------------------------------------ADDS----------------------------------------//
 	
 /**
@@ -148,14 +190,15 @@ const Bound& Object3D::getBound()const
  * @param v2 a face vertex
  * @param v3 a face vertex
  * @param emplace - the position the next face should occupy, or -1
+ * @param source input triangle the face is a fragment of (see Face::getSource)
  * 
  * @return -1 if the face was able to be placed. return "emplace" otherwise
  */
-int Object3D::addFace(int v1, int v2, int v3, int testedUntil)
+int Object3D::addFace(int v1, int v2, int v3, int testedUntil, int source)
 {
 	if(!(vertices[v1].equals(vertices[v2])||vertices[v1].equals(vertices[v3])||vertices[v2].equals(vertices[v3])))
 	{
-		Face face(vertices, v1, v2, v3, testedUntil);
+		Face face(vertices, v1, v2, v3, testedUntil, source);
 		
 		#ifdef _PREVENT_INFINITE
 		for(int i=0; i<faces.size(); i++)
@@ -166,7 +209,12 @@ int Object3D::addFace(int v1, int v2, int v3, int testedUntil)
 
 		if(face.getArea()>TOL)
 		{
-			faces.emplace_back(vertices, v1, v2, v3, testedUntil);
+			size_t capacity = faces.capacity();
+			faces.emplace_back(vertices, v1, v2, v3, testedUntil, source);
+			if(faces.capacity()!=capacity)
+			{
+				trackAllocation(capacity*sizeof(Face));
+			}
 			return 0;
 		}
 		else
@@ -201,7 +249,12 @@ int Object3D::addVertex(Point3f pos, Colour3f color, int status)
 
 	if(i==vertices.size())
 	{
+		size_t capacity = vertices.capacity();
 		vertices.push_back(vertex);
+		if(vertices.capacity()!=capacity)
+		{
+			trackAllocation(capacity*sizeof(Vertex));
+		}
 	}
 	else
 	{
@@ -209,19 +262,74 @@ int Object3D::addVertex(Point3f pos, Colour3f color, int status)
 	}
 	return i;
 }
-	
-//-------------------------FACES_SPLITTING_METHODS------------------------------//
 
-double Object3D::getTotalArea() const
+/**
+ * Adds an adjacent vertex to a vertex, accounting the memory of its adjacency list
+ * 
+ * @param vertex vertex receiving the adjacency
+ * @param index adjacent vertex index
+ */
+void Object3D::addAdjacentVertex(Vertex& vertex, int index)
 {
-	double sum = 0;
-	for(auto& face: this->faces)
+	size_t capacity = vertex.getAdjacentVertices().capacity();
+	vertex.addAdjacentVertex(index);
+	size_t newCapacity = vertex.getAdjacentVertices().capacity();
+	if(newCapacity!=capacity)
 	{
-		sum += face.getArea();
+		adjacencyBytes += (newCapacity-capacity)*sizeof(int);
+		trackAllocation(capacity*sizeof(int));
 	}
-	return sum;
+}
+
+//-------------------------------MEMORY_ACCOUNTING-------------------------------//
+
+/**
+ * Gets the bytes allocated by the vertices, faces and adjacency lists
+ * 
+ * @return allocated bytes
+ */
+long long Object3D::getHeldBytes() const
+{
+	return vertices.capacity()*sizeof(Vertex) + faces.capacity()*sizeof(Face) + adjacencyBytes;
 }
 
+/**
+ * Accounts an allocation of the current stage. A reallocated buffer is released
+ * only after its content is moved, so both are counted in the peak.
+ * 
+ * @param releasedBytes size of the buffer released by the reallocation (0 if none)
+ */
+void Object3D::trackAllocation(long long releasedBytes)
+{
+	statistics.allocations[stage]++;
+	long long held = getHeldBytes()+releasedBytes;
+	if(held>statistics.peakBytes[stage])
+	{
+		statistics.peakBytes[stage] = held;
+	}
+}
+
+/**
+ * Records the memory held at the end of the current stage
+ * 
+ * @param transientBytes bytes held during the stage besides the object, released at its end
+ */
+void Object3D::endStage(long long transientBytes)
+{
+	long long* current = statistics.currentBytes[stage];
+	current[BooleanStatistics::VERTICES] = vertices.capacity()*sizeof(Vertex);
+	current[BooleanStatistics::FACES] = faces.capacity()*sizeof(Face);
+	current[BooleanStatistics::ADJACENCY] = adjacencyBytes;
+	
+	long long held = getHeldBytes()+transientBytes;
+	if(held>statistics.peakBytes[stage])
+	{
+		statistics.peakBytes[stage] = held;
+	}
+}
+	
+//-------------------------FACES_SPLITTING_METHODS------------------------------//
+
 /**
  * Split faces so that none face is intercepted by a face of other object
  * 
@@ -229,15 +337,22 @@ double Object3D::getTotalArea() const
  */
 void Object3D::splitFaces(const Object3D& object)
 {
+	TRACE_SCOPE("Object3D::splitFaces");
 	Line line;
 	std::vector<Segment> segments;
 	double distFace1Vert1, distFace1Vert2, distFace1Vert3, distFace2Vert1, distFace2Vert2, distFace2Vert3;
 	int signFace1Vert1, signFace1Vert2, signFace1Vert3, signFace2Vert1, signFace2Vert2, signFace2Vert3;
-	int numFacesBefore = getNumFaces();
 	int numFacesStart = getNumFaces();
-	int facesIgnored = 0;
+	double start = BooleanStatistics::getTime();
+	stage = BooleanStatistics::SPLIT;
+	statistics.peakBytes[stage] = 0;
+	statistics.allocations[stage] = 0;
+	statistics.facesBeforeSplit = numFacesStart;
 	
-	double totalArea = getTotalArea();
+	#ifdef UNBBOOLEAN_VALIDATE
+	//updated by checkSplit after each face break
+	splitAreaChange = 0;
+	#endif
 
 	//if the objects bounds overlap...								
 	if(getBound().overlap(object.getBound()))
@@ -255,7 +370,12 @@ void Object3D::splitFaces(const Object3D& object)
 				{
 					//if object1 face bound and object2 face bound overlap...  
 					const Face& face2 = object.getFace(j);
-					if(face1.getBound().overlap(face2.getBound()))
+					statistics.pairsTested++;
+					if(!face1.getBound().overlap(face2.getBound()))
+					{
+						statistics.pairsRejected++;
+					}
+					else
 					{
 						//PART I - DO TWO POLIGONS INTERSECT?
 						//POSSIBLE RESULTS: INTERSECT, NOT_INTERSECT, COPLANAR
@@ -299,27 +419,11 @@ void Object3D::splitFaces(const Object3D& object)
 								//if the two segments intersect...
 								if(segment1.intersect(segment2))
 								{
+									statistics.segmentIntersections++;
+									
 									//PART II - SUBDIVIDING NON-COPLANAR POLYGONS
-									int lastNumFaces = getNumFaces();
 									this->splitFace(i, segment1, segment2, j+1);
-
-									#ifdef _DEBUG
-									int currNumFaces = getNumFaces();
-									double currArea = getTotalArea();
-
-									if(std::abs(currArea-totalArea) > TOL)
-									{
-										fprintf(stderr,"area changed from %f to %f and faces from %d to %d at step (%d,%d) by (%.3e)\n",totalArea, currArea,lastNumFaces, currNumFaces, i, j, std::abs(totalArea-currArea));
-									}
-									else
-									{
-										//fprintf(stderr,"face split from %d to %d but area stayed consistent at step (%d,%d)\n",lastNumFaces,currNumFaces,i,j);
-									}
-									totalArea = currArea;
-									#endif
 									
-																		
-									#ifdef _DEBUG
 									#ifdef _PREVENT_INFINITE
 									//prevent from infinite loop (with a loss of faces...)
 									if(numFacesStart*20<getNumFaces())
@@ -328,7 +432,6 @@ void Object3D::splitFaces(const Object3D& object)
 										return;
 									}
 									#endif
-									#endif
 							
 									//if the face in the position isn't the same, there was a break 
 									if(i<faces.size() && !face1.equals(getFace(i))) 
@@ -342,8 +445,145 @@ void Object3D::splitFaces(const Object3D& object)
 					}
 				}
 			}
+			else
+			{
+				statistics.facesRejected++;
+			}
+		}
+	}
+	statistics.facesAfterSplit = getNumFaces();
+	//the two segments of the pair being split live on the stack
+	endStage(2*sizeof(Segment));
+	statistics.stageTimes[BooleanStatistics::SPLIT] = BooleanStatistics::getTime()-start;
+	
+	#ifdef UNBBOOLEAN_VALIDATE
+	if(std::abs(splitAreaChange) > 1e-5)
+	{
+		std::cerr<<"splitFaces: area changed by "<<splitAreaChange<<" and faces from "<<numFacesStart<<" to "<<getNumFaces()<<std::endl;
+	}
+	#endif
+}
+
+/**
+ * Split faces so that none face is intercepted by a face of other object, gathering
+ * first all the segments crossing each face and then triangulating it once with all
+ * of them (see FaceSplitter). Faces are processed in parallel; only the new faces and
+ * vertices are added serially.
+ * 
+ * @param object the other object 3d used to make the split 
+ */
+void Object3D::splitFacesBatched(const Object3D& object)
+{
+	TRACE_SCOPE("Object3D::splitFacesBatched");
+	int numFacesStart = getNumFaces();
+	double start = BooleanStatistics::getTime();
+	stage = BooleanStatistics::SPLIT;
+	statistics.peakBytes[stage] = 0;
+	statistics.allocations[stage] = 0;
+	statistics.facesBeforeSplit = numFacesStart;
+	
+	#ifdef UNBBOOLEAN_VALIDATE
+	//updated by checkSplit after each face break
+	splitAreaChange = 0;
+	#endif
+
+	//counters of each face: rejected, pairs tested, pairs rejected, segment intersections
+	std::vector<std::array<int,4>> counters(numFacesStart, {0, 0, 0, 0});
+	std::vector<std::unique_ptr<FaceSplitter>> splitters(numFacesStart);
+	if(getBound().overlap(object.getBound()))
+	{
+		Parallel::forEach(0, numFacesStart, [&](int i)
+		{
+			const Face& face1 = faces[i];
+			Bound bound1 = face1.getBound();
+			if(!bound1.overlap(object.getBound()))
+			{
+				counters[i][0]++;
+				return;
+			}
+			Point3f startPos, endPos;
+			for(int j=face1.getStart();j<object.getNumFaces();j++)
+			{
+				const Face& face2 = object.getFace(j);
+				counters[i][1]++;
+				if(!bound1.overlap(face2.getBound()))
+				{
+					counters[i][2]++;
+				}
+				else if(intersectFaces(face1, face2, startPos, endPos))
+				{
+					counters[i][3]++;
+					if(!splitters[i])
+					{
+						splitters[i].reset(new FaceSplitter(face1.v1().getPosition(), face1.v2().getPosition(), face1.v3().getPosition()));
+					}
+					splitters[i]->addSegment(startPos, endPos);
+				}
+			}
+		}, 16);
+	}
+
+	long long splitterBytes = splitters.capacity()*sizeof(std::unique_ptr<FaceSplitter>) + counters.capacity()*sizeof(counters[0]);
+	for(int i=0;i<numFacesStart;i++)
+	{
+		statistics.facesRejected += counters[i][0];
+		statistics.pairsTested += counters[i][1];
+		statistics.pairsRejected += counters[i][2];
+		statistics.segmentIntersections += counters[i][3];
+		if(splitters[i])
+		{
+			splitterBytes += sizeof(FaceSplitter)+splitters[i]->getMemoryUsage();
 		}
 	}
+	trackAllocation(splitterBytes);
+
+	//replace the faces from the last, so that removing one doesn't move those still to replace
+	std::vector<int> points;
+	for(int i=numFacesStart-1;i>=0;i--)
+	{
+		if(!splitters[i])
+		{
+			continue;
+		}
+		const FaceSplitter& splitter = *splitters[i];
+		Face face = faces[i];
+		REMOVE(faces,i);
+		statistics.facesRetriangulated++;
+		
+		points.assign(splitter.getNumPoints(), -1);
+		for(int corner=0;corner<3;corner++)
+		{
+			points[corner] = face.v[corner];
+			if(splitter.isOnSegment(corner))
+			{
+				vertices[face.v[corner]].setStatus(Vertex::BOUNDARY);
+			}
+		}
+		const std::vector<int>& triangles = splitter.getTriangles();
+		for(int point : triangles)
+		{
+			if(points[point]<0)
+			{
+				points[point] = addVertex(splitter.getPoint(point), face.v1().getColor(), Vertex::BOUNDARY);
+			}
+		}
+		for(size_t j=0;j<triangles.size();j+=3)
+		{
+			addFace(points[triangles[j]], points[triangles[j+1]], points[triangles[j+2]], object.getNumFaces(), face.getSource());
+		}
+		checkSplit(face,current_faces);
+	}
+	
+	statistics.facesAfterSplit = getNumFaces();
+	endStage(splitterBytes);
+	statistics.stageTimes[BooleanStatistics::SPLIT] = BooleanStatistics::getTime()-start;
+	
+	#ifdef UNBBOOLEAN_VALIDATE
+	if(std::abs(splitAreaChange) > 1e-5)
+	{
+		std::cerr<<"splitFacesBatched: area changed by "<<splitAreaChange<<" and faces from "<<numFacesStart<<" to "<<getNumFaces()<<std::endl;
+	}
+	#endif
 }
 
 /**
@@ -353,7 +593,7 @@ void Object3D::splitFaces(const Object3D& object)
  * @param face face representing the plane where it is contained
  * @return the closest distance from the vertex to the plane
  */
-double Object3D::computeDistance(const Vertex& vertex, const Face& face) const
+double Object3D::computeDistance(const Vertex& vertex, const Face& face)
 {
 	Vector3f normal = face.getNormal();
 	double a = normal.x;
@@ -363,6 +603,56 @@ double Object3D::computeDistance(const Vertex& vertex, const Face& face) const
 	return a*vertex.x + b*vertex.y + c*vertex.z + d;
 }
 
+/**
+ * Computes the segment where two faces cross each other: the part of the line where
+ * their planes meet that lies inside both
+ * 
+ * @param face1 a face
+ * @param face2 another face
+ * @param startPos output, segment start
+ * @param endPos output, segment end
+ * @return true if the faces cross each other, false if they don't or are coplanar
+ */
+bool Object3D::intersectFaces(const Face& face1, const Face& face2, Point3f& startPos, Point3f& endPos)
+{
+	//distances signs from the face1 vertices to the face2 plane
+	double distFace1Vert1 = computeDistance(face1.v1(), face2);
+	double distFace1Vert2 = computeDistance(face1.v2(), face2);
+	double distFace1Vert3 = computeDistance(face1.v3(), face2);
+	int signFace1Vert1 = (distFace1Vert1>TOL? 1 :(distFace1Vert1<-TOL? -1 : 0)); 
+	int signFace1Vert2 = (distFace1Vert2>TOL? 1 :(distFace1Vert2<-TOL? -1 : 0));
+	int signFace1Vert3 = (distFace1Vert3>TOL? 1 :(distFace1Vert3<-TOL? -1 : 0));
+	if(signFace1Vert1==signFace1Vert2 && signFace1Vert2==signFace1Vert3)
+	{
+		return false;
+	}
+	
+	//distances signs from the face2 vertices to the face1 plane
+	double distFace2Vert1 = computeDistance(face2.v1(), face1);
+	double distFace2Vert2 = computeDistance(face2.v2(), face1);
+	double distFace2Vert3 = computeDistance(face2.v3(), face1);
+	int signFace2Vert1 = (distFace2Vert1>TOL? 1 :(distFace2Vert1<-TOL? -1 : 0)); 
+	int signFace2Vert2 = (distFace2Vert2>TOL? 1 :(distFace2Vert2<-TOL? -1 : 0));
+	int signFace2Vert3 = (distFace2Vert3>TOL? 1 :(distFace2Vert3<-TOL? -1 : 0));
+	if(signFace2Vert1==signFace2Vert2 && signFace2Vert2==signFace2Vert3)
+	{
+		return false;
+	}
+	
+	Line line(face1, face2);
+	Segment segment1(line, face1, signFace1Vert1, signFace1Vert2, signFace1Vert3);
+	Segment segment2(line, face2, signFace2Vert1, signFace2Vert2, signFace2Vert3);
+	if(!segment1.intersect(segment2))
+	{
+		return false;
+	}
+	
+	//deeper starting point and ending point, as in splitFace
+	startPos = segment2.getStartDistance() > segment1.getStartDistance()+TOL ? segment2.getStartPosition() : segment1.getStartPosition();
+	endPos = segment2.getEndDistance() < segment1.getEndDistance()-TOL ? segment2.getEndPosition() : segment1.getEndPosition();
+	return true;
+}
+
 /**
  * Split an individual face
  * 
@@ -389,14 +679,12 @@ void Object3D::splitFace(int facePos, Segment& segment1, Segment& segment2, int
 		startDist = segment2.getStartDistance();
 		startType = segment1.getIntermediateType();
 		startPos = segment2.getStartPosition();
-		fprintf(stderr,"start_segment2");
 	}
 	else
 	{
 		startDist = segment1.getStartDistance();
 		startType = segment1.getStartType();
 		startPos = segment1.getStartPosition();
-		fprintf(stderr,"start_segment1");
 	}
 	
 	//ending point: deepest ending point
@@ -405,14 +693,12 @@ void Object3D::splitFace(int facePos, Segment& segment1, Segment& segment2, int
 		endDist = segment2.getEndDistance();
 		endType = segment1.getIntermediateType();
 		endPos = segment2.getEndPosition();
-		fprintf(stderr,"end_segment2");
 	}
 	else
 	{
 		endDist = segment1.getEndDistance();
 		endType = segment1.getEndType();
 		endPos = segment1.getEndPosition();
-		fprintf(stderr,"end_segment1");
 	}		
 	middleType = segment1.getIntermediateType();
 	
@@ -548,19 +834,16 @@ void Object3D::splitFace(int facePos, Segment& segment1, Segment& segment2, int
 		double dot3 = std::abs(segmentVector.dot(vertexVector));
 		if (dot1 > dot2 && dot1 > dot3)
 		{
-			fprintf(stderr,"dot1_");
 			linedVertex = 1;
 			linedVertexPos = face.v1().getPosition();
 		}
 		else if (dot2 > dot3 && dot2 > dot1)
 		{
-			fprintf(stderr,"dot2_");
 			linedVertex = 2;
 			linedVertexPos = face.v2().getPosition();
 		}
 		else
 		{
-			fprintf(stderr,"dot3_");
 			linedVertex = 3;
 			linedVertexPos = face.v3().getPosition();
 		}
@@ -568,21 +851,27 @@ void Object3D::splitFace(int facePos, Segment& segment1, Segment& segment2, int
 		// Now find which of the intersection endpoints is nearest to that vertex.
 		if (linedVertexPos.distance(startPos) > linedVertexPos.distance(endPos))
 		{
-			fprintf(stderr," near1_");
 			breakFaceInFive(facePos, startPos, endPos, linedVertex, testedUntil);
 		}
 		else
 		{
-			fprintf(stderr," near2_");
 			breakFaceInFive(facePos, endPos, startPos, linedVertex, testedUntil);
 		}
 	}
 }
 
-#ifdef _DEBUG
-void Object3D::checkSplit(Face& original, int start_faces){
+#ifdef UNBBOOLEAN_VALIDATE
+/**
+ * Checks that the faces created by a face breaker cover the area of the broken face, and
+ * accumulates the difference into the area change of the current split
+ * 
+ * @param original face that was broken
+ * @param startFaces number of faces before the original face was removed
+ */
+void Object3D::checkSplit(Face& original, int startFaces)
+{
 	double originalArea = original.getArea();
-	int count = (faces.size()-start_faces)+1;
+	int count = (faces.size()-startFaces)+1;
 	double newArea = 0;
 
 	auto it = faces.rbegin();
@@ -590,35 +879,21 @@ void Object3D::checkSplit(Face& original, int start_faces){
 	{
 		newArea+= it->getArea();
 	}
+	splitAreaChange += newArea - originalArea;
 
-	if(std::abs(originalArea - newArea)>1e-5){
-		std::cout<<"\noriginal( \t"<<original.toString()<<" )"<<std::endl;
+	if(std::abs(originalArea - newArea)>1e-5)
+	{
+		std::cerr<<"original( \t"<<original.toString()<<" )"<<std::endl;
 		
 		it = faces.rbegin();
 		for(int i = 0; i<count; ++i, it++)
 		{
-			std::cout<<"newTriangle("<<(count-i)<<", "<<it->toString()<<" )"<<std::endl;
+			std::cerr<<"newTriangle("<<(count-i)<<", "<<it->toString()<<" )"<<std::endl;
 		}
-
-		std::cout<<"";
-
 	}
 }
 #endif
 
-#ifndef _DEBUG
-#define REMOVE(faces, facepos)\
-int current_faces = 0;\
-faces[facepos] = faces.back();\
-faces.pop_back();
-#elifdef _DEBUG
-#define REMOVE(faces, facepos)\
-int current_faces = faces.size();\
-faces[facepos] = faces.back();\
-faces.pop_back();\
-std::cerr<<__FUNCTION__<<__LINE__<<":";
-#endif
-
 	
 /**
  * Face breaker for VERTEX-EDGE-EDGE / EDGE-EDGE-VERTEX
@@ -631,23 +906,24 @@ void Object3D::breakFaceInTwo(int facePos, Point3f newPos, int splitEdge, int te
 {
 	Face face = faces[facePos];
 	REMOVE(faces,facePos);
+	statistics.splits[BooleanStatistics::BREAK_IN_TWO_EDGE]++;
 
 	int vertex = addVertex(newPos, face.v1().getColor(), Vertex::BOUNDARY); 
 					
 	if (splitEdge == 1)
 	{
-		addFace(face.v[0], vertex, face.v[2], testedUntil);
-		addFace(vertex, face.v[1], face.v[2], testedUntil);
+		addFace(face.v[0], vertex, face.v[2], testedUntil, face.getSource());
+		addFace(vertex, face.v[1], face.v[2], testedUntil, face.getSource());
 	}
 	else if (splitEdge == 2)
 	{
-		addFace(face.v[1], vertex, face.v[0], testedUntil);
-		addFace(vertex, face.v[2], face.v[0], testedUntil);
+		addFace(face.v[1], vertex, face.v[0], testedUntil, face.getSource());
+		addFace(vertex, face.v[2], face.v[0], testedUntil, face.getSource());
 	}
 	else
 	{
-		addFace(face.v[2], vertex, face.v[1], testedUntil);
-		addFace(vertex, face.v[0], face.v[1], testedUntil);
+		addFace(face.v[2], vertex, face.v[1], testedUntil, face.getSource());
+		addFace(vertex, face.v[0], face.v[1], testedUntil, face.getSource());
 	}
 	checkSplit(face,current_faces);
 }
@@ -663,23 +939,24 @@ void Object3D::breakFaceInTwo(int facePos, Point3f newPos, Vertex endVertex, int
 {
 	Face face = faces[facePos];
 	REMOVE(faces,facePos);
+	statistics.splits[BooleanStatistics::BREAK_IN_TWO_VERTEX]++;
 	
 	int vertex = addVertex(newPos, face.v1().getColor(), Vertex::BOUNDARY);
 				
 	if (endVertex.equals(face.v1()))
 	{
-		addFace(face.v[0], vertex, face.v[2], testedUntil);
-		addFace(vertex, face.v[1], face.v[2], testedUntil);
+		addFace(face.v[0], vertex, face.v[2], testedUntil, face.getSource());
+		addFace(vertex, face.v[1], face.v[2], testedUntil, face.getSource());
 	}
 	else if (endVertex.equals(face.v2()))
 	{
-		addFace(face.v[1], vertex, face.v[0], testedUntil);
-		addFace(vertex, face.v[2], face.v[0], testedUntil);
+		addFace(face.v[1], vertex, face.v[0], testedUntil, face.getSource());
+		addFace(vertex, face.v[2], face.v[0], testedUntil, face.getSource());
 	}
 	else
 	{
-		addFace(face.v[2], vertex, face.v[1], testedUntil);
-		addFace(vertex, face.v[0], face.v[1], testedUntil);
+		addFace(face.v[2], vertex, face.v[1], testedUntil, face.getSource());
+		addFace(vertex, face.v[0], face.v[1], testedUntil, face.getSource());
 	}
 	checkSplit(face,current_faces);
 }
@@ -696,27 +973,28 @@ void Object3D::breakFaceInThree(int facePos, Point3f newPos1, Point3f newPos2, i
 {
 	Face face = faces[facePos];
 	REMOVE(faces,facePos);
+	statistics.splits[BooleanStatistics::BREAK_IN_THREE_EDGE]++;
 	
 	int vertex1 = addVertex(newPos1, face.v1().getColor(), Vertex::BOUNDARY);	
 	int vertex2 = addVertex(newPos2, face.v1().getColor(), Vertex::BOUNDARY);
 					
 	if (splitEdge == 1)
 	{
-		addFace(face.v[0], vertex1, face.v[2], testedUntil);
-		addFace(vertex1, vertex2, face.v[2], testedUntil);
-		addFace(vertex2, face.v[1], face.v[2], testedUntil);
+		addFace(face.v[0], vertex1, face.v[2], testedUntil, face.getSource());
+		addFace(vertex1, vertex2, face.v[2], testedUntil, face.getSource());
+		addFace(vertex2, face.v[1], face.v[2], testedUntil, face.getSource());
 	}
 	else if (splitEdge == 2)
 	{
-		addFace(face.v[1], vertex1, face.v[0], testedUntil);
-		addFace(vertex1, vertex2, face.v[0], testedUntil);
-		addFace(vertex2, face.v[2], face.v[0], testedUntil);
+		addFace(face.v[1], vertex1, face.v[0], testedUntil, face.getSource());
+		addFace(vertex1, vertex2, face.v[0], testedUntil, face.getSource());
+		addFace(vertex2, face.v[2], face.v[0], testedUntil, face.getSource());
 	}
 	else
 	{
-		addFace(face.v[2], vertex1, face.v[1], testedUntil);
-		addFace(vertex1, vertex2, face.v[1], testedUntil);
-		addFace(vertex2, face.v[0], face.v[1], testedUntil);
+		addFace(face.v[2], vertex1, face.v[1], testedUntil, face.getSource());
+		addFace(vertex1, vertex2, face.v[1], testedUntil, face.getSource());
+		addFace(vertex2, face.v[0], face.v[1], testedUntil, face.getSource());
 	}
 	checkSplit(face,current_faces);
 }
@@ -732,26 +1010,27 @@ void Object3D::breakFaceInThree(int facePos, Point3f newPos, Vertex endVertex, i
 {
 	Face face = faces[facePos];
 	REMOVE(faces,facePos);
+	statistics.splits[BooleanStatistics::BREAK_IN_THREE_VERTEX]++;
 	
 	int vertex = addVertex(newPos, face.v1().getColor(), Vertex::BOUNDARY);
 					
 	if (endVertex.equals(face.v1()))
 	{
-		addFace(face.v[0], face.v[1], vertex, testedUntil);
-		addFace(face.v[1], face.v[2], vertex, testedUntil);
-		addFace(face.v[2], face.v[0], vertex, testedUntil);
+		addFace(face.v[0], face.v[1], vertex, testedUntil, face.getSource());
+		addFace(face.v[1], face.v[2], vertex, testedUntil, face.getSource());
+		addFace(face.v[2], face.v[0], vertex, testedUntil, face.getSource());
 	}
 	else if (endVertex.equals(face.v2()))
 	{
-		addFace(face.v[1], face.v[2], vertex, testedUntil);
-		addFace(face.v[2], face.v[0], vertex, testedUntil);
-		addFace(face.v[0], face.v[1], vertex, testedUntil);
+		addFace(face.v[1], face.v[2], vertex, testedUntil, face.getSource());
+		addFace(face.v[2], face.v[0], vertex, testedUntil, face.getSource());
+		addFace(face.v[0], face.v[1], vertex, testedUntil, face.getSource());
 	}
 	else
 	{
-		addFace(face.v[2], face.v[0], vertex, testedUntil);
-		addFace(face.v[0], face.v[1], vertex, testedUntil);
-		addFace(face.v[1], face.v[2], vertex, testedUntil);
+		addFace(face.v[2], face.v[0], vertex, testedUntil, face.getSource());
+		addFace(face.v[0], face.v[1], vertex, testedUntil, face.getSource());
+		addFace(face.v[1], face.v[2], vertex, testedUntil, face.getSource());
 	}
 	checkSplit(face,current_faces);
 }
@@ -769,45 +1048,46 @@ void Object3D::breakFaceInThree(int facePos, Point3f newPos1, Point3f newPos2, V
 {
 	Face face = faces[facePos];
 	REMOVE(faces,facePos);
+	statistics.splits[BooleanStatistics::BREAK_IN_THREE_EDGES]++;
 	
 	int vertex1 = addVertex(newPos1, face.v1().getColor(), Vertex::BOUNDARY);
 	int vertex2 = addVertex(newPos2, face.v1().getColor(), Vertex::BOUNDARY);
 					
 	if (startVertex.equals(face.v1()) && endVertex.equals(face.v2()))
 	{
-		addFace(face.v[0], vertex1, vertex2, testedUntil);
-		addFace(face.v[0], vertex2, face.v[2], testedUntil);
-		addFace(vertex1, face.v[1], vertex2, testedUntil);
+		addFace(face.v[0], vertex1, vertex2, testedUntil, face.getSource());
+		addFace(face.v[0], vertex2, face.v[2], testedUntil, face.getSource());
+		addFace(vertex1, face.v[1], vertex2, testedUntil, face.getSource());
 	}
 	else if (startVertex.equals(face.v2()) && endVertex.equals(face.v1()))
 	{
-		addFace(face.v[0], vertex2, vertex1, testedUntil);
-		addFace(face.v[0], vertex1, face.v[2], testedUntil);
-		addFace(vertex2, face.v[1], vertex1, testedUntil);
+		addFace(face.v[0], vertex2, vertex1, testedUntil, face.getSource());
+		addFace(face.v[0], vertex1, face.v[2], testedUntil, face.getSource());
+		addFace(vertex2, face.v[1], vertex1, testedUntil, face.getSource());
 	}
 	else if (startVertex.equals(face.v2()) && endVertex.equals(face.v3()))
 	{
-		addFace(face.v[1], vertex1, vertex2, testedUntil);
-		addFace(face.v[1], vertex2, face.v[0], testedUntil);
-		addFace(vertex1, face.v[2], vertex2, testedUntil);
+		addFace(face.v[1], vertex1, vertex2, testedUntil, face.getSource());
+		addFace(face.v[1], vertex2, face.v[0], testedUntil, face.getSource());
+		addFace(vertex1, face.v[2], vertex2, testedUntil, face.getSource());
 	}
 	else if (startVertex.equals(face.v3()) && endVertex.equals(face.v2()))
 	{
-		addFace(face.v[1], vertex2, vertex1, testedUntil);
-		addFace(face.v[1], vertex1, face.v[0], testedUntil);
-		addFace(vertex2, face.v[2], vertex1, testedUntil);
+		addFace(face.v[1], vertex2, vertex1, testedUntil, face.getSource());
+		addFace(face.v[1], vertex1, face.v[0], testedUntil, face.getSource());
+		addFace(vertex2, face.v[2], vertex1, testedUntil, face.getSource());
 	}
 	else if (startVertex.equals(face.v3()) && endVertex.equals(face.v1()))
 	{
-		addFace(face.v[2], vertex1, vertex2, testedUntil);
-		addFace(face.v[2], vertex2, face.v[1], testedUntil);
-		addFace(vertex1, face.v[0], vertex2, testedUntil);
+		addFace(face.v[2], vertex1, vertex2, testedUntil, face.getSource());
+		addFace(face.v[2], vertex2, face.v[1], testedUntil, face.getSource());
+		addFace(vertex1, face.v[0], vertex2, testedUntil, face.getSource());
 	}
 	else
 	{
-		addFace(face.v[2], vertex2, vertex1, testedUntil);
-		addFace(face.v[2], vertex1, face.v[1], testedUntil);
-		addFace(vertex2, face.v[0], vertex1, testedUntil);
+		addFace(face.v[2], vertex2, vertex1, testedUntil, face.getSource());
+		addFace(face.v[2], vertex1, face.v[1], testedUntil, face.getSource());
+		addFace(vertex2, face.v[0], vertex1, testedUntil, face.getSource());
 	}
 	checkSplit(face,current_faces);
 }
@@ -822,12 +1102,13 @@ void Object3D::breakFaceInThree(int facePos, Point3f newPos, int testedUntil)
 {
 	Face face = faces[facePos];
 	REMOVE(faces,facePos);
+	statistics.splits[BooleanStatistics::BREAK_IN_THREE_POINT]++;
 	
 	int vertex = addVertex(newPos, face.v1().getColor(), Vertex::BOUNDARY);
 			
-	addFace(face.v[0], face.v[1], vertex, testedUntil);
-	addFace(face.v[1], face.v[2], vertex, testedUntil);
-	addFace(face.v[2], face.v[0], vertex, testedUntil);
+	addFace(face.v[0], face.v[1], vertex, testedUntil, face.getSource());
+	addFace(face.v[1], face.v[2], vertex, testedUntil, face.getSource());
+	addFace(face.v[2], face.v[0], vertex, testedUntil, face.getSource());
 	
 	checkSplit(face,current_faces);
 }
@@ -844,30 +1125,31 @@ void Object3D::breakFaceInFour(int facePos, Point3f newPos1, Point3f newPos2, Ve
 {
 	Face face = faces[facePos];
 	REMOVE(faces,facePos);
+	statistics.splits[BooleanStatistics::BREAK_IN_FOUR]++;
 	
 	int vertex1 = addVertex(newPos1, face.v1().getColor(), Vertex::BOUNDARY);
 	int vertex2 = addVertex(newPos2, face.v1().getColor(), Vertex::BOUNDARY);
 	
 	if (endVertex.equals(face.v1()))
 	{
-		addFace(face.v[0], vertex1, vertex2, testedUntil);
-		addFace(vertex1, face.v[1], vertex2, testedUntil);
-		addFace(face.v[1], face.v[2], vertex2, testedUntil);
-		addFace(face.v[2], face.v[0], vertex2, testedUntil);
+		addFace(face.v[0], vertex1, vertex2, testedUntil, face.getSource());
+		addFace(vertex1, face.v[1], vertex2, testedUntil, face.getSource());
+		addFace(face.v[1], face.v[2], vertex2, testedUntil, face.getSource());
+		addFace(face.v[2], face.v[0], vertex2, testedUntil, face.getSource());
 	}
 	else if (endVertex.equals(face.v2()))
 	{
-		addFace(face.v[1], vertex1, vertex2, testedUntil);
-		addFace(vertex1, face.v[2], vertex2, testedUntil);
-		addFace(face.v[2], face.v[0], vertex2, testedUntil);
-		addFace(face.v[0], face.v[1], vertex2, testedUntil);
+		addFace(face.v[1], vertex1, vertex2, testedUntil, face.getSource());
+		addFace(vertex1, face.v[2], vertex2, testedUntil, face.getSource());
+		addFace(face.v[2], face.v[0], vertex2, testedUntil, face.getSource());
+		addFace(face.v[0], face.v[1], vertex2, testedUntil, face.getSource());
 	}
 	else
 	{
-		addFace(face.v[2], vertex1, vertex2, testedUntil);
-		addFace(vertex1, face.v[0], vertex2, testedUntil);
-		addFace(face.v[0], face.v[1], vertex2, testedUntil);
-		addFace(face.v[1], face.v[2], vertex2, testedUntil);
+		addFace(face.v[2], vertex1, vertex2, testedUntil, face.getSource());
+		addFace(vertex1, face.v[0], vertex2, testedUntil, face.getSource());
+		addFace(face.v[0], face.v[1], vertex2, testedUntil, face.getSource());
+		addFace(face.v[1], face.v[2], vertex2, testedUntil, face.getSource());
 	}
 	checkSplit(face,current_faces);
 
@@ -885,6 +1167,7 @@ void Object3D::breakFaceInFive(int facePos, Point3f newPos1, Point3f newPos2, in
 {
 	Face face = faces[facePos];
 	REMOVE(faces,facePos);
+	statistics.splits[BooleanStatistics::BREAK_IN_FIVE]++;
 	
 	int vertex1 = addVertex(newPos1, face.v1().getColor(), Vertex::BOUNDARY);
 	int vertex2 = addVertex(newPos2, face.v1().getColor(), Vertex::BOUNDARY);
@@ -892,28 +1175,27 @@ void Object3D::breakFaceInFive(int facePos, Point3f newPos1, Point3f newPos2, in
 	double cont = 0;		
 	if (linedVertex == 1)
 	{
-		addFace(face.v[1], face.v[2], vertex1, testedUntil);
-		addFace(face.v[1], vertex1, vertex2, testedUntil);
-		addFace(face.v[2], vertex2, vertex1, testedUntil);
-		addFace(face.v[1], vertex2, face.v[0], testedUntil);
-		addFace(face.v[2], face.v[0], vertex2, testedUntil);
+		addFace(face.v[1], face.v[2], vertex1, testedUntil, face.getSource());
+		addFace(face.v[1], vertex1, vertex2, testedUntil, face.getSource());
+		addFace(face.v[2], vertex2, vertex1, testedUntil, face.getSource());
+		addFace(face.v[1], vertex2, face.v[0], testedUntil, face.getSource());
+		addFace(face.v[2], face.v[0], vertex2, testedUntil, face.getSource());
 	}
 	else if(linedVertex == 2)
 	{
-		addFace(face.v[2], face.v[0], vertex1, testedUntil);
-		addFace(face.v[2], vertex1, vertex2, testedUntil);
-		addFace(face.v[0], vertex2, vertex1, testedUntil);
-		addFace(face.v[2], vertex2, face.v[1], testedUntil);
-		addFace(face.v[0], face.v[1], vertex2, testedUntil);
+		addFace(face.v[2], face.v[0], vertex1, testedUntil, face.getSource());
+		addFace(face.v[2], vertex1, vertex2, testedUntil, face.getSource());
+		addFace(face.v[0], vertex2, vertex1, testedUntil, face.getSource());
+		addFace(face.v[2], vertex2, face.v[1], testedUntil, face.getSource());
+		addFace(face.v[0], face.v[1], vertex2, testedUntil, face.getSource());
 	}
 	else
 	{
-		fprintf(stderr,"_else");
-		addFace(face.v[0], face.v[1], vertex1, testedUntil);
-		addFace(face.v[0], vertex1, vertex2, testedUntil);
-		addFace(face.v[1], vertex2, vertex1, testedUntil);
-		addFace(face.v[0], vertex2, face.v[2], testedUntil);
-		addFace(face.v[1], face.v[2], vertex2, testedUntil);
+		addFace(face.v[0], face.v[1], vertex1, testedUntil, face.getSource());
+		addFace(face.v[0], vertex1, vertex2, testedUntil, face.getSource());
+		addFace(face.v[1], vertex2, vertex1, testedUntil, face.getSource());
+		addFace(face.v[0], vertex2, face.v[2], testedUntil, face.getSource());
+		addFace(face.v[1], face.v[2], vertex2, testedUntil, face.getSource());
 	}
 	
 	checkSplit(face,current_faces);
@@ -928,16 +1210,22 @@ void Object3D::breakFaceInFive(int facePos, Point3f newPos1, Point3f newPos2, in
  */
 void Object3D::classifyFaces(Object3D& object)
 {
+	TRACE_SCOPE("Object3D::classifyFaces");
+	double start = BooleanStatistics::getTime();
+	stage = BooleanStatistics::CLASSIFY;
+	statistics.peakBytes[stage] = 0;
+	statistics.allocations[stage] = 0;
+	
 	//calculate adjacency information
 	for(int i=0;i<this->getNumFaces();i++)
 	{
 		Face& face = getFace(i); // this needs to be rewritten for c++
-		face.v1().addAdjacentVertex(face.v[1]);
-		face.v1().addAdjacentVertex(face.v[2]);
-		face.v2().addAdjacentVertex(face.v[0]);
-		face.v2().addAdjacentVertex(face.v[2]);
-		face.v3().addAdjacentVertex(face.v[0]);
-		face.v3().addAdjacentVertex(face.v[1]);
+		addAdjacentVertex(face.v1(), face.v[1]);
+		addAdjacentVertex(face.v1(), face.v[2]);
+		addAdjacentVertex(face.v2(), face.v[0]);
+		addAdjacentVertex(face.v2(), face.v[2]);
+		addAdjacentVertex(face.v3(), face.v[0]);
+		addAdjacentVertex(face.v3(), face.v[1]);
 	}
 	
 	//for each face
@@ -949,7 +1237,8 @@ void Object3D::classifyFaces(Object3D& object)
 		if(face.simpleClassify()==false)
 		{
 			//makes the ray trace classification
-			face.rayTraceClassify(object);
+			statistics.perturbRetries += face.rayTraceClassify(object);
+			statistics.rayTraceClassified++;
 			
 			//mark the vertices
 			if(face.v1().getStatus()==Vertex::UNKNOWN) 
@@ -965,19 +1254,35 @@ void Object3D::classifyFaces(Object3D& object)
 				face.v3().mark(face.getStatus());
 			}
 		}
+		else
+		{
+			statistics.simpleClassified++;
+		}
 	}
+	endStage(0);
+	statistics.stageTimes[BooleanStatistics::CLASSIFY] = BooleanStatistics::getTime()-start;
 }
 
-/** Inverts faces classified as INSIDE, making its normals point outside. Usually
- *  used into the second solid when the difference is applied. */
-void Object3D::invertInsideFaces()
+/**
+ * Classify faces as being inside, outside or on boundary of other object, using the
+ * generalized winding number of that object. Each face is classified on its own, so
+ * the faces are processed in parallel and no vertex marking is needed.
+ * 
+ * @param windingNumber winding number of the object 3d used for the comparison
+ */
+void Object3D::classifyFaces(const WindingNumber& windingNumber)
 {
-	for(int i=0;i<getNumFaces();i++)
+	TRACE_SCOPE("Object3D::classifyFaces");
+	double start = BooleanStatistics::getTime();
+	stage = BooleanStatistics::CLASSIFY;
+	statistics.peakBytes[stage] = 0;
+	statistics.allocations[stage] = 0;
+	Parallel::forEach(0, getNumFaces(), [this, &windingNumber](int i)
 	{
-		Face& face = getFace(i);
-		if(face.getStatus()==Face::INSIDE)
-		{
-			face.invert();
-		}
-	}
-}
\ No newline at end of file
+		faces[i].windingNumberClassify(windingNumber);
+	});
+	statistics.windingNumberClassified = getNumFaces();
+	//the winding number of the other object is alive while this object is classified
+	endStage(windingNumber.getMemoryUsage());
+	statistics.stageTimes[BooleanStatistics::CLASSIFY] = BooleanStatistics::getTime()-start;
+}
@@ -5,12 +5,14 @@
 #include"Vertex.hpp"
 #include"Face.hpp"
 #include"Bound.hpp"
+#include"BooleanStatistics.hpp"
 
 class Solid;
 class Point3f;
 class Face;
 class Segment;
 class Colour3f;
+class WindingNumber;
 
 /**
  * Data structure about a 3d solid to apply bool operations in it.
@@ -39,26 +41,40 @@ public:
 
 	int getNumFaces() const;
 
+	int getNumVertices() const;
+
 	const Face& getFace(int index) const;
 	Face& getFace(int index);
 
 	const Bound& getBound()const;
 
+	const BooleanStatistics& getStatistics() const;
+
 	void splitFaces(const Object3D& object);
 
+	void splitFacesBatched(const Object3D& object);
+
 	void classifyFaces(Object3D& object);
 	
-	void invertInsideFaces();
+	void classifyFaces(const WindingNumber& windingNumber);
+	
+	static bool intersectFaces(const Face& face1, const Face& face2, Point3f& startPos, Point3f& endPos);
 
 private:
 
-	double getTotalArea() const;
-
-	int addFace(int v1, int v2, int v3, int testedUntil = 0);
+	int addFace(int v1, int v2, int v3, int testedUntil = 0, int source = -1);
 
 	int addVertex(Point3f pos, Colour3f color, int status);
 
-	double computeDistance(const Vertex& vertex, const Face& face)const;
+	void addAdjacentVertex(Vertex& vertex, int index);
+
+	long long getHeldBytes() const;
+
+	void trackAllocation(long long releasedBytes);
+
+	void endStage(long long transientBytes);
+
+	static double computeDistance(const Vertex& vertex, const Face& face);
 
 	void splitFace(int facePos, Segment& segment1, Segment& segment2, int testedUntil);
 
@@ -78,8 +94,8 @@ private:
 
 	void breakFaceInFive(int facePos, Point3f newPos1, Point3f newPos2, int linedVertex, int testedUntil);
 
-#ifdef _DEBUG
-	void checkSplit(Face& original, int count);
+#ifdef UNBBOOLEAN_VALIDATE
+	void checkSplit(Face& original, int startFaces);
 #endif
 
 	/** solid vertices  */
@@ -88,6 +104,16 @@ private:
 	std::vector<Face> faces;
 	/** object representing the solid extremes */
 	Bound bound;
+	/** work done on this object faces */
+	BooleanStatistics statistics;
+	/** stage whose memory is being accounted */
+	int stage = BooleanStatistics::CONSTRUCT;
+	/** bytes allocated by the vertex adjacency lists */
+	long long adjacencyBytes = 0;
+#ifdef UNBBOOLEAN_VALIDATE
+	/** total area added by the face breakers during the last splitFaces, should stay 0 */
+	double splitAreaChange = 0;
+#endif
 
 	
 	static std::vector<Vertex> emptyVertices;
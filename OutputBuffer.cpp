@@ -0,0 +1,157 @@
+#include "OutputBuffer.hpp"
+#include <algorithm>
+
+/**
+ * Stream buffer collecting the output in large blocks before handing it to another stream.
+ * 
+ * @author akatsia-games on github.com
+ */
+
+//---------------------------------CONSTRUCTORS---------------------------------//
+
+/**
+ * Constructs the buffer
+ * 
+ * @param target stream receiving the blocks
+ * @param asynchronous true to write the blocks from a background thread
+ * @param size size of a block
+ */
+OutputBuffer::OutputBuffer(std::basic_ostream<char>& target, bool asynchronous, size_t size)
+	:target(target)
+	,current(0)
+	,asynchronous(asynchronous)
+	,pending(-1)
+	,pendingSize(0)
+	,closing(false)
+	,failed(false)
+{
+	blocks[0].resize(std::max<size_t>(size, 1));
+	if(asynchronous)
+	{
+		blocks[1].resize(blocks[0].size());
+		writer = std::thread(&OutputBuffer::writeBlocks, this);
+	}
+	setp(blocks[0].data(), blocks[0].data()+blocks[0].size());
+}
+
+/** Writes what is left and stops the background writer */
+OutputBuffer::~OutputBuffer()
+{
+	sync();
+	if(asynchronous)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			closing = true;
+		}
+		condition.notify_all();
+		writer.join();
+	}
+}
+
+//-------------------------------------OVERRIDES--------------------------------//
+
+/**
+ * Called when the current block is full
+ * 
+ * @param character character that didn't fit
+ * @return the character, or eof if the target failed
+ */
+OutputBuffer::int_type OutputBuffer::overflow(int_type character)
+{
+	handOver();
+	if(!traits_type::eq_int_type(character, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(character);
+		pbump(1);
+	}
+	return hasFailed() ? traits_type::eof() : traits_type::not_eof(character);
+}
+
+/**
+ * Writes the current block and flushes the target
+ * 
+ * @return 0 on success, -1 if the target failed
+ */
+int OutputBuffer::sync()
+{
+	handOver();
+	waitWriter();
+	//the writer is idle until the next hand over
+	bool flushed = (bool)target.flush();
+	std::lock_guard<std::mutex> lock(mutex);
+	failed = failed || !flushed;
+	return failed ? -1 : 0;
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/** Hands the current block to the writer and starts filling the other one */
+void OutputBuffer::handOver()
+{
+	size_t size = pptr()-pbase();
+	if(size>0)
+	{
+		if(asynchronous)
+		{
+			waitWriter();
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				pending = current;
+				pendingSize = size;
+			}
+			condition.notify_all();
+			current = 1-current;
+		}
+		else if(!target.write(pbase(), size))
+		{
+			failed = true;
+		}
+	}
+	setp(blocks[current].data(), blocks[current].data()+blocks[current].size());
+}
+
+/** Waits until the block handed to the background writer is written */
+void OutputBuffer::waitWriter()
+{
+	if(asynchronous)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [this](){ return pending<0; });
+	}
+}
+
+/**
+ * Checks if a write to the target failed, as recorded by the thread writing it
+ * 
+ * @return true if the target failed
+ */
+bool OutputBuffer::hasFailed()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return failed;
+}
+
+/** Background writer loop */
+void OutputBuffer::writeBlocks()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while(true)
+	{
+		condition.wait(lock, [this](){ return pending>=0 || closing; });
+		if(pending<0)
+		{
+			return;
+		}
+		
+		int block = pending;
+		size_t size = pendingSize;
+		lock.unlock();
+		bool written = (bool)target.write(blocks[block].data(), size);
+		lock.lock();
+		
+		failed = failed || !written;
+		pending = -1;
+		condition.notify_all();
+	}
+}
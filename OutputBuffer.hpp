@@ -0,0 +1,69 @@
+#ifndef __OUTPUT_BUFFER__
+#define __OUTPUT_BUFFER__
+
+#include<iostream>
+#include<vector>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+
+/**
+ * Stream buffer collecting the output in large blocks before handing it to another stream.
+ * 
+ * <br><br>In asynchronous mode two blocks are used: while a background thread writes a
+ * full block into the target stream the other one keeps being filled, so formatting 
+ * and writing overlap. The target only sees whole blocks and is flushed on sync() and
+ * on destruction.
+ * 
+ * @author akatsia-games on github.com
+ */
+class OutputBuffer : public std::streambuf
+{
+public:
+	OutputBuffer(std::basic_ostream<char>& target, bool asynchronous = false, size_t size = DEFAULT_SIZE);
+
+	OutputBuffer(const OutputBuffer& other) = delete;
+
+	OutputBuffer& operator=(const OutputBuffer& other) = delete;
+
+	~OutputBuffer();
+
+	/** default size of a block (1 MB) */
+	static const size_t DEFAULT_SIZE = 1<<20;
+
+protected:
+	int_type overflow(int_type character) override;
+
+	int sync() override;
+
+private:
+	void handOver();
+
+	void waitWriter();
+
+	bool hasFailed();
+
+	void writeBlocks();
+
+	/** stream receiving the blocks */
+	std::basic_ostream<char>& target;
+	/** blocks, only the first one is used in synchronous mode */
+	std::vector<char> blocks[2];
+	/** block being filled */
+	int current;
+	
+	/** true if a background thread writes the full blocks */
+	bool asynchronous;
+	/** background writer */
+	std::thread writer;
+	std::mutex mutex;
+	std::condition_variable condition;
+	/** block waiting to be written (-1 if none) and its size */
+	int pending;
+	size_t pendingSize;
+	/** set to stop the background writer */
+	bool closing;
+	/** set when a write to the target failed, so the target state isn't read while the writer uses it */
+	bool failed;
+};
+#endif //__OUTPUT_BUFFER__
@@ -0,0 +1,82 @@
+#ifndef __PARALLEL__
+#define __PARALLEL__
+
+#include<algorithm>
+#include<atomic>
+#include<thread>
+#include<vector>
+#include"Trace.hpp"
+
+/**
+ * Minimal helper to spread independent loop iterations over worker threads.
+ * 
+ * <br><br>Iterations are handed out in blocks through an atomic counter, so the 
+ * function must be safe to call concurrently for different indices.
+ * 
+ * @author akatsia-games on github.com
+ */
+class Parallel
+{
+public:
+	/**
+	 * Gets the number of threads used by the parallel loops
+	 * 
+	 * @return number of worker threads (at least one)
+	 */
+	static int getNumThreads()
+	{
+		unsigned int hardware = std::thread::hardware_concurrency();
+		return hardware == 0 ? 1 : (int)hardware;
+	}
+
+	/**
+	 * Calls a function for every index in [begin, end), possibly from several threads
+	 * 
+	 * @param begin first index
+	 * @param end one past the last index
+	 * @param function function receiving the index
+	 * @param grain number of consecutive indices taken by a thread at once
+	 */
+	template<typename Function>
+	static void forEach(int begin, int end, Function function, int grain = 64)
+	{
+		int count = end - begin;
+		int numThreads = std::min(getNumThreads(), (count + grain - 1) / std::max(grain, 1));
+		if(numThreads <= 1)
+		{
+			for(int i = begin; i < end; i++)
+			{
+				function(i);
+			}
+			return;
+		}
+
+		std::atomic<int> next(begin);
+		auto worker = [&]()
+		{
+			TRACE_SCOPE("Parallel::forEach");
+			for(int start = next.fetch_add(grain); start < end; start = next.fetch_add(grain))
+			{
+				int stop = std::min(start + grain, end);
+				for(int i = start; i < stop; i++)
+				{
+					function(i);
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(numThreads - 1);
+		for(int t = 1; t < numThreads; t++)
+		{
+			threads.emplace_back(worker);
+		}
+		worker();
+		for(std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+};
+
+#endif //__PARALLEL__
@@ -0,0 +1,678 @@
+#include "PlyFile.hpp"
+#include "MappedFile.hpp"
+#include "Parallel.hpp"
+#include "Solid.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+/**
+ * Reader and writer for ASCII and binary (little or big endian) PLY files.
+ * 
+ * @author akatsia-games on github.com
+ */
+
+//---------------------------------------READ-----------------------------------//
+
+/**
+ * Loads a PLY file into a solid
+ * 
+ * @param path file path
+ * @param solid solid receiving the data
+ * @param color color of the vertices if the file has no colors
+ * @return true if the file was read, false if it couldn't be opened or is malformed
+ */
+bool PlyFile::load(const std::string& path, Solid& solid, Colour3f color)
+{
+	TRACE_SCOPE("PlyFile::load");
+	MappedFile file(path);
+	if(!file.isOpen())
+	{
+		return false;
+	}
+	return parse(file.getData(), file.getData()+file.getSize(), solid, color);
+}
+
+/**
+ * Parses the contents of a PLY file into a solid
+ * 
+ * @param begin first byte of the file
+ * @param end one past the last byte of the file
+ * @param solid solid receiving the data, left untouched if the contents are malformed
+ * @param color color of the vertices if the file has no colors
+ * @return true if the contents were read, false if they are malformed
+ */
+bool PlyFile::parse(const char* begin, const char* end, Solid& solid, Colour3f color)
+{
+	TRACE_SCOPE("PlyFile::parse");
+	const char* position = begin;
+	int format;
+	std::vector<Element> elements;
+	if(!parseHeader(position, end, format, elements))
+	{
+		return false;
+	}
+	bool swap = (format==BINARY_LITTLE_ENDIAN) != isHostLittleEndian();
+	
+	std::vector<Point3f> vertices;
+	std::vector<Colour3f> colors;
+	std::vector<int> indices;
+	std::atomic<bool> valid(true);
+	for(const Element& element : elements)
+	{
+		//the header count is trusted only as far as the rest of the file can hold the items
+		if(element.count>(end-position)/getLeastItemSize(element, format))
+		{
+			return false;
+		}
+		
+		//find where every block of items starts, and for faces how many triangles precede it
+		long long numBlocks = (element.count+BLOCK_SIZE-1)/BLOCK_SIZE;
+		std::vector<const char*> blockStart(numBlocks+1);
+		std::vector<long long> blockTriangles(numBlocks+1, 0);
+		int recordSize = (format==ASCII) ? 0 : getRecordSize(element);
+		for(long long block=0;block<numBlocks;block++)
+		{
+			blockStart[block] = position;
+			long long numItems = std::min<long long>(BLOCK_SIZE, element.count-block*BLOCK_SIZE);
+			long long numTriangles = 0;
+			if(recordSize>0)
+			{
+				if(end-position<numItems*recordSize)
+				{
+					return false;
+				}
+				position += numItems*recordSize;
+			}
+			else
+			{
+				for(long long i=0;i<numItems && position!=nullptr;i++)
+				{
+					position = skipItem(position, end, element, format, &numTriangles);
+				}
+				if(position==nullptr)
+				{
+					return false;
+				}
+			}
+			blockTriangles[block+1] = blockTriangles[block]+numTriangles;
+		}
+		blockStart[numBlocks] = position;
+		
+		if(element.name=="vertex")
+		{
+			//property positions and offsets inside fixed size records
+			int coordinates[3] = {-1, -1, -1};
+			int channels[3] = {-1, -1, -1};
+			std::vector<int> offsets;
+			int offset = 0;
+			for(size_t i=0;i<element.properties.size();i++)
+			{
+				const Property& property = element.properties[i];
+				const char* names[6] = {"x", "y", "z", "red", "green", "blue"};
+				for(int j=0;j<6;j++)
+				{
+					if(property.countType==0 && property.name==names[j])
+					{
+						(j<3 ? coordinates[j] : channels[j-3]) = i;
+					}
+				}
+				offsets.push_back(offset);
+				offset += getTypeSize(property.type);
+			}
+			if(coordinates[0]<0 || coordinates[1]<0 || coordinates[2]<0)
+			{
+				return false;
+			}
+			bool hasColors = channels[0]>=0 && channels[1]>=0 && channels[2]>=0;
+			bool bulkCopy = recordSize>0 && !swap 
+				&& element.properties[coordinates[0]].type==DOUBLE && offsets[coordinates[0]]==0
+				&& element.properties[coordinates[1]].type==DOUBLE && offsets[coordinates[1]]==8
+				&& element.properties[coordinates[2]].type==DOUBLE && offsets[coordinates[2]]==16;
+			
+			vertices.resize(element.count);
+			colors.assign(element.count, color);
+			Parallel::forEach(0, numBlocks, [&](int block)
+			{
+				long long first = (long long)block*BLOCK_SIZE;
+				long long numItems = std::min<long long>(BLOCK_SIZE, element.count-first);
+				const char* item = blockStart[block];
+				
+				//same layout as the solid vertices: plain copy
+				if(bulkCopy && !hasColors)
+				{
+					if(recordSize==sizeof(Point3f))
+					{
+						memcpy(&vertices[first], item, numItems*sizeof(Point3f));
+					}
+					else
+					{
+						for(long long i=0;i<numItems;i++,item+=recordSize)
+						{
+							memcpy(&vertices[first+i], item, sizeof(Point3f));
+						}
+					}
+					return;
+				}
+				
+				double values[6] = {};
+				for(long long i=0;i<numItems && item!=nullptr;i++)
+				{
+					for(size_t j=0;j<element.properties.size() && item!=nullptr;j++)
+					{
+						const Property& property = element.properties[j];
+						double value = 0;
+						if(property.countType!=0)
+						{
+							double count = 0;
+							item = readValue(item, end, property.countType, format, count);
+							if(item!=nullptr && !isValidCount(count, item, end, format==ASCII ? 1 : getTypeSize(property.type)))
+							{
+								item = nullptr;
+							}
+							for(int k=0;item!=nullptr && k<(int)count;k++)
+							{
+								item = readValue(item, end, property.type, format, value);
+							}
+							continue;
+						}
+						item = readValue(item, end, property.type, format, value);
+						for(int k=0;k<3;k++)
+						{
+							if((int)j==coordinates[k])
+							{
+								values[k] = value;
+							}
+							else if((int)j==channels[k])
+							{
+								//integer channels go from 0 to their maximum value
+								int type = property.type;
+								double scale = (type==UCHAR || type==CHAR) ? 255.0 : ((type==USHORT || type==SHORT) ? 65535.0 : 1.0);
+								values[3+k] = value/scale;
+							}
+						}
+					}
+					//a truncated record isn't stored
+					if(item==nullptr)
+					{
+						break;
+					}
+					vertices[first+i] = {values[0], values[1], values[2]};
+					if(hasColors)
+					{
+						colors[first+i] = {values[3], values[4], values[5]};
+					}
+				}
+				if(item==nullptr)
+				{
+					valid = false;
+				}
+			}, 1);
+		}
+		else if(element.name=="face")
+		{
+			indices.resize(3*blockTriangles[numBlocks]);
+			Parallel::forEach(0, numBlocks, [&](int block)
+			{
+				long long first = (long long)block*BLOCK_SIZE;
+				long long numItems = std::min<long long>(BLOCK_SIZE, element.count-first);
+				const char* item = blockStart[block];
+				int* triangle = indices.data()+3*blockTriangles[block];
+				std::vector<int> polygon;
+				for(long long i=0;i<numItems && item!=nullptr;i++)
+				{
+					for(const Property& property : element.properties)
+					{
+						double value = 0;
+						if(property.countType==0)
+						{
+							item = readValue(item, end, property.type, format, value);
+						}
+						else
+						{
+							double count = 0;
+							item = readValue(item, end, property.countType, format, count);
+							if(item!=nullptr && !isValidCount(count, item, end, format==ASCII ? 1 : getTypeSize(property.type)))
+							{
+								item = nullptr;
+							}
+							bool isIndexList = property.name=="vertex_indices" || property.name=="vertex_index";
+							polygon.clear();
+							for(int k=0;item!=nullptr && k<(int)count;k++)
+							{
+								item = readValue(item, end, property.type, format, value);
+								if(item!=nullptr && isIndexList)
+								{
+									//indices are whole numbers that an int holds
+									if(!(value>=0 && value<=INT_MAX && value==std::floor(value)))
+									{
+										item = nullptr;
+										break;
+									}
+									polygon.push_back((int)value);
+								}
+							}
+							if(isIndexList && item!=nullptr)
+							{
+								for(size_t k=2;k<polygon.size();k++)
+								{
+									*(triangle++) = polygon[0];
+									*(triangle++) = polygon[k-1];
+									*(triangle++) = polygon[k];
+								}
+							}
+						}
+						if(item==nullptr)
+						{
+							break;
+						}
+					}
+				}
+				if(item==nullptr)
+				{
+					valid = false;
+				}
+			}, 1);
+		}
+	}
+	
+	if(!valid)
+	{
+		return false;
+	}
+	for(int index : indices)
+	{
+		if(index<0 || index>=(int)vertices.size())
+		{
+			return false;
+		}
+	}
+	
+	solid.setData(std::move(vertices), std::move(indices), std::move(colors));
+	return true;
+}
+
+//--------------------------------------WRITE-----------------------------------//
+
+/**
+ * Writes a solid as a PLY file: double precision coordinates, 8 bit colors and 
+ * triangular faces
+ * 
+ * @param solid solid to be written
+ * @param plyFile stream, opened in binary mode for binary files
+ * @param binary true for a binary file in the host byte order, false for an ASCII file
+ */
+void PlyFile::write(const Solid& solid, std::basic_ostream<char>& plyFile, bool binary)
+{
+	TRACE_SCOPE("PlyFile::write");
+	const std::vector<Point3f>& vertices = solid.getVertices();
+	const std::vector<int>& indices = solid.getIndices();
+	const std::vector<Colour3f>& colors = solid.getColors();
+	bool hasColors = colors.size()==vertices.size();
+	
+	std::string chunk = "ply\nformat ";
+	chunk += !binary ? "ascii" : (isHostLittleEndian() ? "binary_little_endian" : "binary_big_endian");
+	chunk += " 1.0\ncomment UnBBoolean\nelement vertex "+std::to_string(vertices.size());
+	chunk += "\nproperty double x\nproperty double y\nproperty double z\n";
+	if(hasColors)
+	{
+		chunk += "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+	}
+	chunk += "element face "+std::to_string(indices.size()/3)+"\nproperty list uchar int vertex_indices\nend_header\n";
+	
+	char number[32];
+	auto flush = [&chunk, &plyFile]()
+	{
+		if(chunk.size()>(1<<16))
+		{
+			plyFile.write(chunk.data(), chunk.size());
+			chunk.clear();
+		}
+	};
+	
+	for(size_t i=0;i<vertices.size();i++)
+	{
+		unsigned char channels[3] = {};
+		if(hasColors)
+		{
+			double values[3] = {colors[i].r, colors[i].g, colors[i].b};
+			for(int j=0;j<3;j++)
+			{
+				channels[j] = (unsigned char)std::lround(std::min(std::max(values[j], 0.0), 1.0)*255.0);
+			}
+		}
+		if(binary)
+		{
+			chunk.append((const char*)&vertices[i], sizeof(Point3f));
+			if(hasColors)
+			{
+				chunk.append((const char*)channels, sizeof(channels));
+			}
+		}
+		else
+		{
+			for(double value : {vertices[i].x, vertices[i].y, vertices[i].z})
+			{
+				chunk.append(number, std::to_chars(number, number+sizeof(number), value).ptr);
+				chunk += ' ';
+			}
+			for(int j=0;j<(hasColors ? 3 : 0);j++)
+			{
+				chunk.append(number, std::to_chars(number, number+sizeof(number), (int)channels[j]).ptr);
+				chunk += ' ';
+			}
+			chunk.back() = '\n';
+		}
+		flush();
+	}
+	
+	for(size_t i=0;i+2<indices.size();i+=3)
+	{
+		if(binary)
+		{
+			chunk += (char)3;
+			chunk.append((const char*)&indices[i], 3*sizeof(int));
+		}
+		else
+		{
+			chunk += '3';
+			for(int j=0;j<3;j++)
+			{
+				chunk += ' ';
+				chunk.append(number, std::to_chars(number, number+sizeof(number), indices[i+j]).ptr);
+			}
+			chunk += '\n';
+		}
+		flush();
+	}
+	plyFile.write(chunk.data(), chunk.size());
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/**
+ * Parses the header of the file
+ * 
+ * @param position start of the file, moved to the first byte after the header
+ * @param end end of the file
+ * @param format file format (ASCII, BINARY_LITTLE_ENDIAN or BINARY_BIG_ENDIAN)
+ * @param elements elements declared
+ * @return true if the header is valid, false otherwise
+ */
+bool PlyFile::parseHeader(const char*& position, const char* end, int& format, std::vector<Element>& elements)
+{
+	format = 0;
+	bool first = true;
+	while(position<end)
+	{
+		const char* lineEnd = (const char*)memchr(position, '\n', end-position);
+		if(lineEnd==nullptr)
+		{
+			return false;
+		}
+		std::istringstream line(std::string(position, lineEnd));
+		position = lineEnd+1;
+		
+		std::string keyword;
+		line>>keyword;
+		if(first)
+		{
+			if(keyword!="ply")
+			{
+				return false;
+			}
+			first = false;
+		}
+		else if(keyword=="format")
+		{
+			std::string name;
+			line>>name;
+			format = (name=="ascii") ? ASCII : ((name=="binary_little_endian") ? BINARY_LITTLE_ENDIAN : ((name=="binary_big_endian") ? BINARY_BIG_ENDIAN : 0));
+		}
+		else if(keyword=="element")
+		{
+			Element element;
+			if(!(line>>element.name>>element.count) || element.count<0)
+			{
+				return false;
+			}
+			elements.push_back(element);
+		}
+		else if(keyword=="property")
+		{
+			Property property;
+			std::string type;
+			line>>type;
+			property.countType = 0;
+			if(type=="list")
+			{
+				std::string countType;
+				line>>countType>>type;
+				property.countType = getType(countType);
+				if(property.countType==0)
+				{
+					return false;
+				}
+			}
+			property.type = getType(type);
+			if(!(line>>property.name) || property.type==0 || elements.empty())
+			{
+				return false;
+			}
+			elements.back().properties.push_back(property);
+		}
+		else if(keyword=="end_header")
+		{
+			return format!=0;
+		}
+	}
+	return false;
+}
+
+/**
+ * Gets a property type from its name
+ * 
+ * @param name type name, old style (uchar) or sized (uint8)
+ * @return property type, 0 if unknown
+ */
+int PlyFile::getType(const std::string& name)
+{
+	if(name=="char" || name=="int8") return CHAR;
+	if(name=="uchar" || name=="uint8") return UCHAR;
+	if(name=="short" || name=="int16") return SHORT;
+	if(name=="ushort" || name=="uint16") return USHORT;
+	if(name=="int" || name=="int32") return INT;
+	if(name=="uint" || name=="uint32") return UINT;
+	if(name=="float" || name=="float32") return FLOAT;
+	if(name=="double" || name=="float64") return DOUBLE;
+	return 0;
+}
+
+/**
+ * Gets the binary size of a property type
+ * 
+ * @param type property type
+ * @return size in bytes
+ */
+int PlyFile::getTypeSize(int type)
+{
+	switch(type)
+	{
+		case CHAR: case UCHAR: return 1;
+		case SHORT: case USHORT: return 2;
+		case INT: case UINT: case FLOAT: return 4;
+		default: return 8;
+	}
+}
+
+/**
+ * Gets the size of the binary records of an element
+ * 
+ * @param element element declaration
+ * @return record size in bytes, 0 if the records have lists and vary in size
+ */
+int PlyFile::getRecordSize(const Element& element)
+{
+	int size = 0;
+	for(const Property& property : element.properties)
+	{
+		if(property.countType!=0)
+		{
+			return 0;
+		}
+		size += getTypeSize(property.type);
+	}
+	return size;
+}
+
+/**
+ * Reads a value
+ * 
+ * @param position current position
+ * @param end end of the file
+ * @param type property type
+ * @param format file format
+ * @param value value read
+ * @return position after the value, null if it couldn't be read
+ */
+const char* PlyFile::readValue(const char* position, const char* end, int type, int format, double& value)
+{
+	if(format==ASCII)
+	{
+		while(position<end && (*position==' ' || (*position>='\t' && *position<='\r')))
+		{
+			position++;
+		}
+		if(position<end && *position=='+')
+		{
+			position++;
+		}
+		std::from_chars_result result = std::from_chars(position, end, value);
+		return (result.ec==std::errc()) ? result.ptr : nullptr;
+	}
+	
+	int size = getTypeSize(type);
+	if(end-position<size)
+	{
+		return nullptr;
+	}
+	unsigned char bytes[8];
+	memcpy(bytes, position, size);
+	if((format==BINARY_LITTLE_ENDIAN) != isHostLittleEndian())
+	{
+		std::reverse(bytes, bytes+size);
+	}
+	switch(type)
+	{
+		case CHAR: { int8_t v; memcpy(&v, bytes, 1); value = v; break; }
+		case UCHAR: { uint8_t v; memcpy(&v, bytes, 1); value = v; break; }
+		case SHORT: { int16_t v; memcpy(&v, bytes, 2); value = v; break; }
+		case USHORT: { uint16_t v; memcpy(&v, bytes, 2); value = v; break; }
+		case INT: { int32_t v; memcpy(&v, bytes, 4); value = v; break; }
+		case UINT: { uint32_t v; memcpy(&v, bytes, 4); value = v; break; }
+		case FLOAT: { float v; memcpy(&v, bytes, 4); value = v; break; }
+		default: memcpy(&value, bytes, 8); break;
+	}
+	return position+size;
+}
+
+/**
+ * Skips an item of an element
+ * 
+ * @param position start of the item
+ * @param end end of the file
+ * @param element element declaration
+ * @param format file format
+ * @param numTriangles incremented by the triangles of the item polygon, if any
+ * @return position after the item, null if it couldn't be read
+ */
+const char* PlyFile::skipItem(const char* position, const char* end, const Element& element, int format, long long* numTriangles)
+{
+	for(const Property& property : element.properties)
+	{
+		double value;
+		if(property.countType==0)
+		{
+			position = readValue(position, end, property.type, format, value);
+		}
+		else
+		{
+			double count;
+			position = readValue(position, end, property.countType, format, count);
+			if(position==nullptr || !isValidCount(count, position, end, format==ASCII ? 1 : getTypeSize(property.type)))
+			{
+				return nullptr;
+			}
+			if(format==ASCII)
+			{
+				for(int k=0;position!=nullptr && k<(int)count;k++)
+				{
+					position = readValue(position, end, property.type, format, value);
+				}
+			}
+			else
+			{
+				position += (long long)count*getTypeSize(property.type);
+			}
+			if(count>=3 && (property.name=="vertex_indices" || property.name=="vertex_index"))
+			{
+				*numTriangles += (long long)count-2;
+			}
+		}
+		if(position==nullptr)
+		{
+			return nullptr;
+		}
+	}
+	return position;
+}
+
+/**
+ * Gets the least bytes an item of an element takes: one character per value on ASCII
+ * files, and empty lists on binary ones
+ * 
+ * @param element element declaration
+ * @param format file format
+ * @return least item size in bytes, at least 1
+ */
+long long PlyFile::getLeastItemSize(const Element& element, int format)
+{
+	long long size = 0;
+	for(const Property& property : element.properties)
+	{
+		size += (format==ASCII) ? 1 : getTypeSize(property.countType!=0 ? property.countType : property.type);
+	}
+	return std::max<long long>(size, 1);
+}
+
+/**
+ * Checks a list size read from the file before it is used
+ * 
+ * @param count list size read
+ * @param position position after the list size
+ * @param end end of the file
+ * @param valueSize least bytes taken by each value of the list
+ * @return true if the size is a whole non-negative number of values the rest of the file can hold
+ */
+bool PlyFile::isValidCount(double count, const char* position, const char* end, int valueSize)
+{
+	return std::isfinite(count) && count>=0 && count==std::floor(count) && count*valueSize<=(double)(end-position);
+}
+
+/**
+ * Checks the byte order of the host
+ * 
+ * @return true if the host is little endian
+ */
+bool PlyFile::isHostLittleEndian()
+{
+	const uint16_t one = 1;
+	unsigned char first;
+	memcpy(&first, &one, 1);
+	return first==1;
+}
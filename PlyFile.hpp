@@ -0,0 +1,88 @@
+#ifndef __PLY_FILE__
+#define __PLY_FILE__
+
+#include<iostream>
+#include<string>
+#include<vector>
+#include"Point3f.hpp"
+
+class Solid;
+
+/**
+ * Reader and writer for ASCII and binary (little or big endian) PLY files.
+ * 
+ * <br><br>The "x", "y", "z" and optional "red", "green", "blue" properties of the 
+ * "vertex" element and the "vertex_indices" list of the "face" element are read; faces
+ * are split in triangle fans and any other element or property is skipped. 
+ * 
+ * <br><br>The file is mapped in memory. A first sequential pass only finds where every 
+ * block of elements starts (a multiplication for fixed size binary records); the blocks
+ * are then parsed in parallel. Binary vertices stored as three native doubles, the layout
+ * of the solid vertices, are copied in bulk with no conversion at all.
+ * 
+ * @author akatsia-games on github.com
+ */
+class PlyFile
+{
+public:
+	static bool load(const std::string& path, Solid& solid, Colour3f color);
+
+	static bool parse(const char* begin, const char* end, Solid& solid, Colour3f color);
+
+	static void write(const Solid& solid, std::basic_ostream<char>& plyFile, bool binary = true);
+
+private:
+	/** property of an element */
+	struct Property
+	{
+		std::string name;
+		/** value type (CHAR ... DOUBLE) */
+		int type;
+		/** type of the list size, 0 if the property isn't a list */
+		int countType;
+	};
+	/** element declared on the header */
+	struct Element
+	{
+		std::string name;
+		long long count;
+		std::vector<Property> properties;
+	};
+
+	static bool parseHeader(const char*& position, const char* end, int& format, std::vector<Element>& elements);
+
+	static int getType(const std::string& name);
+
+	static int getTypeSize(int type);
+
+	static int getRecordSize(const Element& element);
+
+	static const char* readValue(const char* position, const char* end, int type, int format, double& value);
+
+	static const char* skipItem(const char* position, const char* end, const Element& element, int format, long long* numTriangles);
+
+	static long long getLeastItemSize(const Element& element, int format);
+
+	static bool isValidCount(double count, const char* position, const char* end, int valueSize);
+
+	static bool isHostLittleEndian();
+
+	/** file formats */
+	static const int ASCII = 1;
+	static const int BINARY_LITTLE_ENDIAN = 2;
+	static const int BINARY_BIG_ENDIAN = 3;
+
+	/** property types */
+	static const int CHAR = 1;
+	static const int UCHAR = 2;
+	static const int SHORT = 3;
+	static const int USHORT = 4;
+	static const int INT = 5;
+	static const int UINT = 6;
+	static const int FLOAT = 7;
+	static const int DOUBLE = 8;
+
+	/** number of elements parsed by a task */
+	static const int BLOCK_SIZE = 1<<14;
+};
+#endif //__PLY_FILE__
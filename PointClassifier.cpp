@@ -0,0 +1,191 @@
+#include "PointClassifier.hpp"
+#include "Solid.hpp"
+#include "Vertex.hpp"
+#include "Parallel.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+
+/**
+ * Classifies points as inside, outside or on the boundary of a solid.
+ *
+ * @author akatsia-games on github.com
+ */
+
+//---------------------------------CONSTRUCTORS---------------------------------//
+
+/**
+ * Constructs a classifier for the points around a solid
+ *
+ * @param solid solid the points are classified against
+ * @param tolerance distance under which a point is on the boundary
+ */
+PointClassifier::PointClassifier(const Solid& solid, double tolerance)
+	:windingNumber(solid)
+	,tolerance(tolerance)
+{
+}
+
+//-------------------------------------GETS-------------------------------------//
+
+/**
+ * Classifies a point
+ *
+ * @param point point to be classified
+ * @return Vertex::INSIDE, Vertex::OUTSIDE or Vertex::BOUNDARY
+ */
+int PointClassifier::classify(const Point3f& point) const
+{
+	if(isOnBoundary(point))
+	{
+		return Vertex::BOUNDARY;
+	}
+	return windingNumber.isInside(point) ? Vertex::INSIDE : Vertex::OUTSIDE;
+}
+
+/**
+ * Classifies a batch of points, in parallel
+ *
+ * @param points points to be classified
+ * @return status of each point: Vertex::INSIDE, Vertex::OUTSIDE or Vertex::BOUNDARY
+ */
+std::vector<int> PointClassifier::classify(const std::vector<Point3f>& points) const
+{
+	TRACE_SCOPE("PointClassifier::classify");
+	std::vector<int> statuses(points.size());
+	Parallel::forEach(0, points.size(), [&](int i)
+	{
+		statuses[i] = classify(points[i]);
+	}, 256);
+	return statuses;
+}
+
+/**
+ * Checks if a point is closer to some triangle of the solid than the tolerance
+ *
+ * @param point point to be tested
+ * @return true if the point is on the boundary
+ */
+bool PointClassifier::isOnBoundary(const Point3f& point) const
+{
+	const TriangleTree& tree = windingNumber.getTree();
+	if(tree.getNumNodes()==0)
+	{
+		return false;
+	}
+
+	double squaredTolerance = tolerance*tolerance;
+	int stack[64];
+	int top = 0;
+	stack[top++] = TriangleTree::ROOT;
+	while(top>0)
+	{
+		const TriangleTree::Node& node = tree.getNode(stack[--top]);
+		Point3f min = node.bound.getMin();
+		Point3f max = node.bound.getMax();
+		if(point.x<min.x-tolerance || point.x>max.x+tolerance || point.y<min.y-tolerance || point.y>max.y+tolerance || point.z<min.z-tolerance || point.z>max.z+tolerance)
+		{
+			continue;
+		}
+		if(node.left>=0)
+		{
+			stack[top++] = node.left;
+			stack[top++] = node.right;
+			continue;
+		}
+		for(int i=node.begin;i<node.end;i++)
+		{
+			int triangle = tree.getTriangle(i);
+			if(getSquaredDistance(point, tree.getCorner(triangle,0), tree.getCorner(triangle,1), tree.getCorner(triangle,2))<=squaredTolerance)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * Gets the bytes allocated by the classifier
+ *
+ * @return allocated bytes
+ */
+size_t PointClassifier::getMemoryUsage() const
+{
+	return windingNumber.getMemoryUsage();
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/**
+ * Gets the squared distance from a point to a triangle, through the region of the
+ * triangle (face, edge or corner) its closest point lies in
+ *
+ * <br><br>See: C. Ericson. "Real-Time Collision Detection", 2005, section 5.1.5.
+ *
+ * @param point point to measure
+ * @param p1 first triangle corner
+ * @param p2 second triangle corner
+ * @param p3 third triangle corner
+ * @return squared distance to the closest point of the triangle
+ */
+double PointClassifier::getSquaredDistance(const Point3f& point, const Point3f& p1, const Point3f& p2, const Point3f& p3)
+{
+	Vector3f ab = {p2.x-p1.x, p2.y-p1.y, p2.z-p1.z};
+	Vector3f ac = {p3.x-p1.x, p3.y-p1.y, p3.z-p1.z};
+	Vector3f ap = {point.x-p1.x, point.y-p1.y, point.z-p1.z};
+	Vector3f bp = {point.x-p2.x, point.y-p2.y, point.z-p2.z};
+	Vector3f cp = {point.x-p3.x, point.y-p3.y, point.z-p3.z};
+	double d1 = ab.dot(ap);
+	double d2 = ac.dot(ap);
+	double d3 = ab.dot(bp);
+	double d4 = ac.dot(bp);
+	double d5 = ab.dot(cp);
+	double d6 = ac.dot(cp);
+	double va = d3*d6-d5*d4;
+	double vb = d5*d2-d1*d6;
+	double vc = d1*d4-d3*d2;
+
+	//barycentric coordinates of the closest point on the first corner (s) and the edges
+	double s, t;
+	if(d1<=0 && d2<=0)
+	{
+		s = 0, t = 0;
+	}
+	else if(d3>=0 && d4<=d3)
+	{
+		s = 1, t = 0;
+	}
+	else if(d6>=0 && d5<=d6)
+	{
+		s = 0, t = 1;
+	}
+	else if(vc<=0 && d1>=0 && d3<=0)
+	{
+		s = d1/(d1-d3), t = 0;
+	}
+	else if(vb<=0 && d2>=0 && d6<=0)
+	{
+		s = 0, t = d2/(d2-d6);
+	}
+	else if(va<=0 && d4-d3>=0 && d5-d6>=0)
+	{
+		t = (d4-d3)/((d4-d3)+(d5-d6));
+		s = 1-t;
+	}
+	else
+	{
+		double denominator = va+vb+vc;
+		if(denominator==0)
+		{
+			s = 0, t = 0;
+		}
+		else
+		{
+			s = vb/denominator;
+			t = vc/denominator;
+		}
+	}
+
+	Vector3f offset = {ap.x-s*ab.x-t*ac.x, ap.y-s*ab.y-t*ac.y, ap.z-s*ab.z-t*ac.z};
+	return offset.dot(offset);
+}
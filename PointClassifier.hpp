@@ -0,0 +1,49 @@
+#ifndef __POINT_CLASSIFIER__
+#define __POINT_CLASSIFIER__
+
+#include<vector>
+#include"Point3f.hpp"
+#include"WindingNumber.hpp"
+
+class Solid;
+
+/**
+ * Classifies points as inside, outside or on the boundary of a solid.
+ *
+ * <br><br>A point closer to some triangle than the tolerance is on the boundary, which
+ * is found going down the hierarchy of the winding number through the nodes whose
+ * bound is that close. Otherwise it is inside if its winding number is above one half
+ * (see WindingNumber), which doesn't need the solid to be perfectly closed. The
+ * statuses are those of the vertices: Vertex::INSIDE, Vertex::OUTSIDE and
+ * Vertex::BOUNDARY.
+ *
+ * <br><br>The classifier isn't modified by the queries, so a batch of points is
+ * classified in parallel.
+ *
+ * @author akatsia-games on github.com
+ */
+class PointClassifier
+{
+public:
+	PointClassifier(const Solid& solid, double tolerance = TOL);
+
+	int classify(const Point3f& point) const;
+
+	std::vector<int> classify(const std::vector<Point3f>& points) const;
+
+	bool isOnBoundary(const Point3f& point) const;
+
+	size_t getMemoryUsage() const;
+
+private:
+	static double getSquaredDistance(const Point3f& point, const Point3f& p1, const Point3f& p2, const Point3f& p3);
+
+	/** winding number of the solid, whose hierarchy also serves the boundary test */
+	WindingNumber windingNumber;
+	/** distance under which a point is on the boundary */
+	double tolerance;
+
+	/** default boundary distance, as the Vertex tolerance */
+	constexpr static const double TOL = 1e-5;
+};
+#endif //__POINT_CLASSIFIER__
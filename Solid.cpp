@@ -1,4 +1,12 @@
 #include"Solid.hpp"
+#include"SolidView.hpp"
+#include"Trace.hpp"
+#include"TriangleTree.hpp"
+#include"Parallel.hpp"
+#include"Bound.hpp"
+#include<algorithm>
+#include<charconv>
+#include<mutex>
 
 /**
  * Class representing a 3D solid.
@@ -7,6 +15,28 @@
  * Translated to C++ by akatsia-games on github.com
  */
 
+/** Affine transform, as the first three rows of a 4x4 matrix */
+struct Solid::Transform
+{
+	double matrix[3][4];
+	/** serializes the const readers applying the transform, of the solids sharing it */
+	mutable std::mutex mutex;
+
+	Point3f apply(const Point3f& point) const
+	{
+		return Point3f(matrix[0][0]*point.x+matrix[0][1]*point.y+matrix[0][2]*point.z+matrix[0][3],
+			matrix[1][0]*point.x+matrix[1][1]*point.y+matrix[1][2]*point.z+matrix[1][3],
+			matrix[2][0]*point.x+matrix[2][1]*point.y+matrix[2][2]*point.z+matrix[2][3]);
+	}
+};
+
+/** Bound and mean of a set of vertices */
+struct Solid::Extent
+{
+	Bound bound;
+	Point3f mean;
+};
+
 //--------------------------------CONSTRUCTORS----------------------------------//
 
 /** Constructs an empty solid. */			
@@ -50,9 +80,50 @@ Solid::Solid(std::vector<Point3f>& vertices, std::vector<int>& indices, std::vec
 Solid::Solid(std::basic_istream<char>& solidFile, Colour3f color)
 	:Solid()
 {
+	TRACE_SCOPE("Solid::Solid");
 	loadCoordinateFile(solidFile, color);
 }
 
+/**
+ * Constructs a solid from a binary mesh file mapped in memory (see SolidView). The
+ * arrays are copied in bulk, without any parsing. The solid is left empty if the
+ * file is invalid or some index is out of the vertices range.
+ * 
+ * @param view mapped binary mesh file
+ * @param color solid color, used if the file has no colors
+ */
+Solid::Solid(const SolidView& view, Colour3f color)
+	:Solid()
+{
+	TRACE_SCOPE("Solid::Solid");
+	if(!view.isValid())
+	{
+		return;
+	}
+	
+	vertices.assign(view.getVertices(), view.getVertices()+view.getNumVertices());
+	indices.assign(view.getIndices(), view.getIndices()+3*view.getNumTriangles());
+	for(int index : indices)
+	{
+		if(index<0 || index>=view.getNumVertices())
+		{
+			vertices.clear();
+			indices.clear();
+			return;
+		}
+	}
+	if(view.getColors()!=nullptr)
+	{
+		colors.assign(view.getColors(), view.getColors()+view.getNumVertices());
+	}
+	else
+	{
+		colors.assign(vertices.size(), color);
+	}
+	
+	defineGeometry();
+}
+
 /** Sets the initial features common to all constructors */
 void Solid::setInitialFeatures()
 {	
@@ -70,10 +141,15 @@ void Solid::setInitialFeatures()
  */	
 const std::vector<Point3f>& Solid::getVertices() const
 {
+	applyTransform();
 	return vertices;
 }
 std::vector<Point3f>& Solid::getVertices()
 {
+	applyTransform();
+	//the vertices may be changed through the reference
+	std::atomic_store(&rayTree, std::shared_ptr<const TriangleTree>());
+	std::atomic_store(&extent, std::shared_ptr<const Extent>());
 	return vertices;
 }
 
@@ -87,6 +163,8 @@ const std::vector<int>& Solid::getIndices() const
 }
 std::vector<int>& Solid::getIndices()
 {
+	//the indices may be changed through the reference
+	std::atomic_store(&rayTree, std::shared_ptr<const TriangleTree>());
 	return indices;
 }
 
@@ -133,6 +211,7 @@ double Solid::signedTriangleVolume(Point3f p1, Point3f p2, Point3f p3)
  */
 double Solid::getVolume() const
 {
+	applyTransform();
     double volume = 0;
 	for(int i = 0; i<indices.size(); i+=3)
 	{
@@ -176,6 +255,22 @@ void Solid::setData(const std::vector<Point3f>& vertices, const std::vector<int>
 	setData(vertices, indices, colors);
 }
 
+/**
+ * Sets the solid data, taking over the given arrays instead of copying them
+ * 
+ * @param vertices array of points defining the solid vertices
+ * @param indices array of indices for a array of vertices
+ * @param colors array of colors defining the vertices colors 
+ */
+void Solid::setData(std::vector<Point3f>&& vertices, std::vector<int>&& indices, std::vector<Colour3f>&& colors)
+{
+	this->vertices = std::move(vertices);
+	this->colors = std::move(colors);
+	this->indices = std::move(indices);
+
+	defineGeometry();
+}
+
 //-------------------------GEOMETRICAL_TRANSFORMATIONS-------------------------//
 
 /**
@@ -183,24 +278,19 @@ void Solid::setData(const std::vector<Point3f>& vertices, const std::vector<int>
  * 
  * @param dx translation on the x axis
  * @param dy translation on the y axis
+ * @param dz translation on the z axis
  */
 void Solid::translate(double dx, double dy, double dz)
 {
-	if(dx!=0||dy!=0)
+	if(dx!=0||dy!=0||dz!=0)
 	{
-		for(int i=0;i<vertices.size();i++)
-		{
-			vertices[i].x += dx;
-			vertices[i].y += dy;
-			vertices[i].z += dz;
-		}
-		
-		defineGeometry();
+		const double matrix[3][4] = {{1, 0, 0, dx}, {0, 1, 0, dy}, {0, 0, 1, dz}};
+		composeTransform(matrix);
 	}
 }
 
 /**
- * Applies a rotation into a solid
+ * Applies a rotation into a solid, around the mean of its vertices
  * 
  * @param dx rotation on the x axis
  * @param dy rotation on the y axis
@@ -214,41 +304,20 @@ void Solid::rotate(double dx, double dy)
 				
 	if(dx!=0||dy!=0)
 	{
-		//get mean
+		//the mean moves with the transform, as it is affine
 		Point3f mean = getMean();
 		
-		double newX, newY, newZ;
-		for(int i=0;i<vertices.size();i++)
+		//x rotation followed by the y rotation
+		double matrix[3][4] = {
+			{cosY, sinY*sinX, sinY*cosX, 0},
+			{0, cosX, -sinX, 0},
+			{-sinY, cosY*sinX, cosY*cosX, 0}};
+		for(int i=0;i<3;i++)
 		{
-			vertices[i].x -= mean.x; 
-			vertices[i].y -= mean.y; 
-			vertices[i].z -= mean.z; 
-			
-			//x rotation
-			if(dx!=0)
-			{
-				newY = vertices[i].y*cosX - vertices[i].z*sinX;
-				newZ = vertices[i].y*sinX + vertices[i].z*cosX;
-				vertices[i].y = newY;
-				vertices[i].z = newZ;
-			}
-			
-			//y rotation
-			if(dy!=0)
-			{
-				newX = vertices[i].x*cosY + vertices[i].z*sinY;
-				newZ = -vertices[i].x*sinY + vertices[i].z*cosY;
-				vertices[i].x = newX;
-				vertices[i].z = newZ;
-			}
-									
-			vertices[i].x += mean.x; 
-			vertices[i].y += mean.y; 
-			vertices[i].z += mean.z;
+			matrix[i][3] = (i==0 ? mean.x : i==1 ? mean.y : mean.z)-matrix[i][0]*mean.x-matrix[i][1]*mean.y-matrix[i][2]*mean.z;
 		}
+		composeTransform(matrix);
 	}
-	
-	defineGeometry();
 }
 
 /**
@@ -258,15 +327,7 @@ void Solid::rotate(double dx, double dy)
  */
 void Solid::zoom(double dz)
 {
-	if(dz!=0)
-	{
-		for(int i=0;i<vertices.size();i++)
-		{
-			vertices[i].z += dz;
-		}
-
-		defineGeometry();
-	}
+	translate(0, 0, dz);
 }
 
 /**
@@ -278,23 +339,206 @@ void Solid::zoom(double dz)
  */
 void Solid::scale(double dx, double dy, double dz)
 {
-	for(int i=0;i<vertices.size();i++)
+	const double matrix[3][4] = {{dx, 0, 0, 0}, {0, dy, 0, 0}, {0, 0, dz, 0}};
+	composeTransform(matrix);
+}
+
+/**
+ * Applies an affine transform into the solid, after the ones already applied
+ * 
+ * @param matrix transform of the points as columns, whose last row must be 0 0 0 1
+ * @return false if the matrix isn't affine, in which case the solid is left as it was
+ */
+bool Solid::transform(const double matrix[4][4])
+{
+	if(matrix[3][0]!=0 || matrix[3][1]!=0 || matrix[3][2]!=0 || matrix[3][3]!=1)
 	{
-		vertices[i].x*=dx;
-		vertices[i].y*=dy;
-		vertices[i].z*=dz;
+		return false;
 	}
-	
-	defineGeometry();
+	composeTransform(matrix);
+	return true;
+}
+
+/**
+ * Checks if the solid has a transform not applied to its vertices yet
+ * 
+ * @return true if the next read of the vertices applies a transform
+ */
+bool Solid::hasTransform() const
+{
+	return std::atomic_load(&pendingTransform)!=nullptr;
 }
 
-Vector3f Solid::intersectRay(Vector3f position, Vector3f direction)
-{//work in progress
-	if(position.y > 1 != direction.y < 0){
+/**
+ * Applies the pending transform to the vertices, in a single pass. Concurrent
+ * readers wait for the first one to apply it.
+ */
+void Solid::applyTransform() const
+{
+	if(!std::atomic_load(&pendingTransform))
+	{
+		return;
+	}
+	std::shared_ptr<const Transform> pending = std::atomic_load(&pendingTransform);
+	if(!pending)
+	{
+		return;
+	}
+	std::lock_guard<std::mutex> lock(pending->mutex);
+	if(std::atomic_load(&pendingTransform)!=pending)
+	{
+		return;
+	}
+	TRACE_SCOPE("Solid::applyTransform");
+	for(Point3f& vertex : vertices)
+	{
+		vertex = pending->apply(vertex);
+	}
+	std::atomic_store(&extent, std::shared_ptr<const Extent>());
+	std::atomic_store(&pendingTransform, std::shared_ptr<const Transform>());
+}
+
+/**
+ * Gets the solid bound. With a pending transform, it bounds the transformed corners
+ * of the bound of the stored vertices, without applying the transform.
+ * 
+ * @return bound containing the solid (with NAN coordinates if it has no vertices)
+ */
+Bound Solid::getBound() const
+{
+	std::shared_ptr<const Transform> pending = std::atomic_load(&pendingTransform);
+	if(pending)
+	{
+		std::lock_guard<std::mutex> lock(pending->mutex);
+		if(std::atomic_load(&pendingTransform)==pending)
+		{
+			const Bound& bound = getExtent()->bound;
+			Point3f min = bound.getMin();
+			Point3f max = bound.getMax();
+			std::vector<Point3f> corners;
+			for(int i=0;i<8;i++)
+			{
+				corners.push_back(pending->apply(Point3f((i&1) ? max.x : min.x, (i&2) ? max.y : min.y, (i&4) ? max.z : min.z)));
+			}
+			return Bound(corners);
+		}
+	}
+	return getExtent()->bound;
+}
+
+//---------------------------------RAY_CASTING---------------------------------//
+
+/**
+ * Gets the closest point where a ray hits the solid
+ * 
+ * @param position ray origin
+ * @param direction ray direction
+ * @return hit point, with NAN coordinates if the ray misses the solid
+ */
+Vector3f Solid::intersectRay(Vector3f position, Vector3f direction) const
+{
+	double distance;
+	int triangle;
+	if(!intersectRay(position, direction, distance, triangle))
+	{
 		return {NAN,NAN,NAN};
 	}
-	double k = (1-position.y)/direction.y;
-	return position + direction*k;
+	direction.normalize();
+	return position + direction*distance;
+}
+
+/**
+ * Gets the closest triangle hit by a ray, from either side. The triangles are searched
+ * through a hierarchy built on the first query and kept until the solid changes.
+ * 
+ * @param position ray origin
+ * @param direction ray direction
+ * @param distance output, distance from the origin to the hit (NAN if none)
+ * @param triangle output, position of the triangle hit on the indices array divided by 3 (-1 if none)
+ * @return true if the ray hits the solid, false otherwise
+ */
+bool Solid::intersectRay(const Vector3f& position, const Vector3f& direction, double& distance, int& triangle) const
+{
+	distance = NAN;
+	triangle = -1;
+	double length = direction.length();
+	if(isEmpty() || !(length>0))
+	{
+		return false;
+	}
+	Vector3f unit = {direction.x/length, direction.y/length, direction.z/length};
+	std::shared_ptr<const TriangleTree> tree = getRayTree();
+	
+	//nodes closer than the closest hit so far, the nearest child visited first
+	double closest = INFINITY;
+	int stack[64];
+	int top = 0;
+	if(getEntryDistance(tree->getNode(TriangleTree::ROOT).bound, position, unit, closest)<INFINITY)
+	{
+		stack[top++] = TriangleTree::ROOT;
+	}
+	while(top>0)
+	{
+		const TriangleTree::Node& node = tree->getNode(stack[--top]);
+		if(node.left<0)
+		{
+			for(int i=node.begin;i<node.end;i++)
+			{
+				int current = tree->getTriangle(i);
+				double hit = getHitDistance(position, unit, tree->getCorner(current,0), tree->getCorner(current,1), tree->getCorner(current,2));
+				if(hit<closest)
+				{
+					closest = hit;
+					triangle = current;
+				}
+			}
+			continue;
+		}
+		double left = getEntryDistance(tree->getNode(node.left).bound, position, unit, closest);
+		double right = getEntryDistance(tree->getNode(node.right).bound, position, unit, closest);
+		int nearChild = left<=right ? node.left : node.right;
+		int farChild = left<=right ? node.right : node.left;
+		if(std::max(left, right)<INFINITY)
+		{
+			stack[top++] = farChild;
+		}
+		if(std::min(left, right)<INFINITY)
+		{
+			stack[top++] = nearChild;
+		}
+	}
+	
+	if(triangle<0)
+	{
+		return false;
+	}
+	distance = closest;
+	return true;
+}
+
+/**
+ * Casts a batch of rays in parallel (see intersectRay)
+ * 
+ * @param positions ray origins
+ * @param directions ray directions, one per origin
+ * @param distances output, distance to the closest hit of each ray (NAN if none)
+ * @param triangles output, triangle hit by each ray (-1 if none)
+ */
+void Solid::intersectRays(const std::vector<Vector3f>& positions, const std::vector<Vector3f>& directions, std::vector<double>& distances, std::vector<int>& triangles) const
+{
+	TRACE_SCOPE("Solid::intersectRays");
+	int numRays = std::min(positions.size(), directions.size());
+	distances.resize(numRays);
+	triangles.resize(numRays);
+	if(!isEmpty())
+	{
+		//built once before the threads start
+		getRayTree();
+	}
+	Parallel::forEach(0, numRays, [&](int i)
+	{
+		intersectRay(positions[i], directions[i], distances[i], triangles[i]);
+	}, 256);
 }
 
 //-----------------------------------PRIVATES--------------------------------//
@@ -302,6 +546,10 @@ Vector3f Solid::intersectRay(Vector3f position, Vector3f direction)
 /** Creates a geometry based on the indexes and vertices set for the solid */
 void Solid::defineGeometry()
 {
+	std::atomic_store(&rayTree, std::shared_ptr<const TriangleTree>());
+	std::atomic_store(&pendingTransform, std::shared_ptr<const Transform>());
+	std::atomic_store(&extent, std::shared_ptr<const Extent>());
+	
 	/*GeometryInfo gi = new GeometryInfo(GeometryInfo.TRIANGLE_ARRAY);
 	gi.setCoordinateIndices(indices);
 	gi.setCoordinates(vertices);
@@ -315,6 +563,119 @@ void Solid::defineGeometry()
 	setGeometry(gi.getIndexedGeometryArray());*/
 }
 
+/**
+ * Gets the hierarchy over the triangles used by the ray queries, building it if the
+ * solid changed. Concurrent first queries may build it more than once, but all get a
+ * complete one.
+ * 
+ * @return triangle hierarchy
+ */
+std::shared_ptr<const TriangleTree> Solid::getRayTree() const
+{
+	std::shared_ptr<const TriangleTree> tree = std::atomic_load(&rayTree);
+	if(!tree)
+	{
+		TRACE_SCOPE("Solid::getRayTree");
+		applyTransform();
+		std::vector<Point3f> corners;
+		corners.reserve(indices.size());
+		for(int index : indices)
+		{
+			corners.push_back(vertices[index]);
+		}
+		tree = std::make_shared<const TriangleTree>(corners);
+		std::atomic_store(&rayTree, tree);
+	}
+	return tree;
+}
+
+/**
+ * Gets the distance at which a ray enters a bound, testing the slabs of each axis
+ * 
+ * @param bound bound to be tested
+ * @param position ray origin
+ * @param direction ray direction, normalized
+ * @param maxDistance bounds entered farther away are skipped
+ * @return entry distance (0 if the origin is inside), INFINITY if the ray misses the bound
+ */
+double Solid::getEntryDistance(const Bound& bound, const Vector3f& position, const Vector3f& direction, double maxDistance)
+{
+	Point3f min = bound.getMin();
+	Point3f max = bound.getMax();
+	double mins[3] = {min.x, min.y, min.z};
+	double maxs[3] = {max.x, max.y, max.z};
+	double origins[3] = {position.x, position.y, position.z};
+	double directions[3] = {direction.x, direction.y, direction.z};
+	double enter = 0;
+	double exit = maxDistance;
+	for(int axis=0;axis<3;axis++)
+	{
+		if(directions[axis]==0)
+		{
+			if(origins[axis]<mins[axis] || origins[axis]>maxs[axis])
+			{
+				return INFINITY;
+			}
+			continue;
+		}
+		double near = (mins[axis]-origins[axis])/directions[axis];
+		double far = (maxs[axis]-origins[axis])/directions[axis];
+		if(near>far)
+		{
+			std::swap(near, far);
+		}
+		enter = std::max(enter, near);
+		exit = std::min(exit, far);
+		if(enter>exit)
+		{
+			return INFINITY;
+		}
+	}
+	return enter;
+}
+
+/**
+ * Gets the distance at which a ray hits a triangle, from either side.
+ * 
+ * <br><br>See: T. Moller, B. Trumbore. "Fast, Minimum Storage Ray/Triangle 
+ * Intersection", Journal of Graphics Tools, 1997.
+ * 
+ * @param position ray origin
+ * @param direction ray direction, normalized
+ * @param p1 first triangle corner
+ * @param p2 second triangle corner
+ * @param p3 third triangle corner
+ * @return hit distance, INFINITY if the ray misses the triangle or starts on it
+ */
+double Solid::getHitDistance(const Vector3f& position, const Vector3f& direction, const Point3f& p1, const Point3f& p2, const Point3f& p3)
+{
+	Vector3f edge1 = {p2.x-p1.x, p2.y-p1.y, p2.z-p1.z};
+	Vector3f edge2 = {p3.x-p1.x, p3.y-p1.y, p3.z-p1.z};
+	Vector3f ray = direction;
+	Vector3f normalRay;
+	normalRay.cross(ray, edge2);
+	double determinant = edge1.dot(normalRay);
+	if(determinant==0)
+	{
+		return INFINITY;
+	}
+	Vector3f offset = {position.x-p1.x, position.y-p1.y, position.z-p1.z};
+	double u = offset.dot(normalRay)/determinant;
+	if(u<0 || u>1)
+	{
+		return INFINITY;
+	}
+	Vector3f normalOffset;
+	normalOffset.cross(offset, edge1);
+	double v = direction.dot(normalOffset)/determinant;
+	if(v<0 || u+v>1)
+	{
+		return INFINITY;
+	}
+	double distance = edge2.dot(normalOffset)/determinant;
+	return distance>RAY_TOL ? distance : INFINITY;
+}
+
 /**
  * Loads a coordinates file, setting vertices and indices 
  * 
@@ -354,47 +715,163 @@ void Solid::loadCoordinateFile(std::basic_istream<char>& solidFile, Colour3f col
 }
 
 /**
- * Writes a coordinates file
+ * Writes a coordinates file. Numbers are written with the shortest representation 
+ * that reads back to the same value, and the stream is never flushed; wrap it with 
+ * SolidWriter for large buffers or asynchronous writeback.
  * 
- * @param solidFile file stream
+ * @param solidFile file stream, whose failbit is set if a number can't be formatted
  */
 void Solid::write(std::basic_ostream<char>& solidFile) const
 {
-	solidFile<<vertices.size()<<std::endl;
+	TRACE_SCOPE("Solid::write");
+	applyTransform();
+	char line[128];
+	char* end = line;
+	//formats a number and its separator, keeping the last byte of the line for the separator
+	auto append = [&line, &end](auto value, char separator)
+	{
+		std::to_chars_result result = std::to_chars(end, line+sizeof(line)-1, value);
+		if(result.ec!=std::errc())
+		{
+			return false;
+		}
+		end = result.ptr;
+		*(end++) = separator;
+		return true;
+	};
+	
+	if(!append(vertices.size(), '\n'))
+	{
+		solidFile.setstate(std::ios::failbit);
+		return;
+	}
+	solidFile.write(line, end-line);
 				
 	for(int i=0;i<vertices.size();i++)
 	{
 		auto& vertex = vertices[i];
-		solidFile<<vertex.x<<" "<<vertex.y<<" "<<vertex.z<<std::endl;
+		end = line;
+		if(!append(vertex.x, ' ') || !append(vertex.y, ' ') || !append(vertex.z, '\n'))
+		{
+			solidFile.setstate(std::ios::failbit);
+			return;
+		}
+		solidFile.write(line, end-line);
 	}
 	
-	solidFile<<indices.size()/3<<std::endl;
+	end = line;
+	if(!append(indices.size()/3, '\n'))
+	{
+		solidFile.setstate(std::ios::failbit);
+		return;
+	}
+	solidFile.write(line, end-line);
 				
 	for(int i=0,j=0;i<(indices.size()/3)*3;i=i+3,j++)
 	{
-		solidFile<<indices[i]<<" ";
-		solidFile<<indices[i+1]<<" ";
-		solidFile<<indices[i+2]<<std::endl;
+		end = line;
+		if(!append(indices[i], ' ') || !append(indices[i+1], ' ') || !append(indices[i+2], '\n'))
+		{
+			solidFile.setstate(std::ios::failbit);
+			return;
+		}
+		solidFile.write(line, end-line);
 	}
 }
 
 /**
- * Gets the solid mean
+ * Writes a binary mesh file (see SolidView for the format)
+ * 
+ * @param solidFile file stream, opened in binary mode
+ */
+void Solid::writeBinary(std::basic_ostream<char>& solidFile) const
+{
+	TRACE_SCOPE("Solid::writeBinary");
+	applyTransform();
+	uint32_t version = SolidView::VERSION;
+	uint32_t flags = (colors.size()==vertices.size()) ? SolidView::HAS_COLORS : 0;
+	uint64_t numVertices = vertices.size();
+	uint64_t numTriangles = indices.size()/3;
+	
+	solidFile.write(SolidView::MAGIC, sizeof(SolidView::MAGIC));
+	solidFile.write((const char*)&version, sizeof(version));
+	solidFile.write((const char*)&flags, sizeof(flags));
+	solidFile.write((const char*)&numVertices, sizeof(numVertices));
+	solidFile.write((const char*)&numTriangles, sizeof(numTriangles));
+	
+	solidFile.write((const char*)vertices.data(), numVertices*sizeof(Point3f));
+	solidFile.write((const char*)indices.data(), numTriangles*3*sizeof(int));
+	
+	//pad the indices so the colors stay aligned
+	const char padding[8] = {};
+	solidFile.write(padding, SolidView::getIndicesSize(numTriangles)-numTriangles*3*sizeof(int));
+	
+	if(flags&SolidView::HAS_COLORS)
+	{
+		solidFile.write((const char*)colors.data(), numVertices*sizeof(Colour3f));
+	}
+}
+
+/**
+ * Gets the solid mean, moved by the pending transform
  * 
  * @return point representing the mean
  */
-Point3f Solid::getMean()
+Point3f Solid::getMean() const
 {
-	Point3f mean({0,0,0});
-	for(int i=0;i<vertices.size();i++)
+	std::shared_ptr<const Transform> pending = std::atomic_load(&pendingTransform);
+	Point3f mean = getExtent()->mean;
+	return pending ? pending->apply(mean) : mean;
+}
+
+/**
+ * Composes an affine transform after the pending one, without moving the vertices
+ * 
+ * @param matrix first three rows of the 4x4 transform matrix
+ */
+void Solid::composeTransform(const double matrix[3][4])
+{
+	std::shared_ptr<Transform> composed = std::make_shared<Transform>();
+	std::shared_ptr<const Transform> previous = std::atomic_load(&pendingTransform);
+	for(int i=0;i<3;i++)
 	{
-		mean.x += vertices[i].x;
-		mean.y += vertices[i].y;
-		mean.z += vertices[i].z;
+		for(int j=0;j<4;j++)
+		{
+			double value = j==3 ? matrix[i][3] : 0;
+			for(int k=0;k<3;k++)
+			{
+				value += matrix[i][k]*(previous ? previous->matrix[k][j] : (k==j ? 1 : 0));
+			}
+			composed->matrix[i][j] = value;
+		}
 	}
-	mean.x /= vertices.size();
-	mean.y /= vertices.size();
-	mean.z /= vertices.size();
-	
-	return mean;
-}
\ No newline at end of file
+	std::atomic_store(&pendingTransform, std::shared_ptr<const Transform>(composed));
+	std::atomic_store(&rayTree, std::shared_ptr<const TriangleTree>());
+}
+
+/**
+ * Gets the bound and mean of the vertices as stored, computing them if the vertices
+ * changed
+ * 
+ * @return bound and mean of the stored vertices
+ */
+std::shared_ptr<const Solid::Extent> Solid::getExtent() const
+{
+	std::shared_ptr<const Extent> current = std::atomic_load(&extent);
+	if(!current)
+	{
+		Point3f mean(0., 0., 0.);
+		for(const Point3f& vertex : vertices)
+		{
+			mean.x += vertex.x;
+			mean.y += vertex.y;
+			mean.z += vertex.z;
+		}
+		mean.x /= vertices.size();
+		mean.y /= vertices.size();
+		mean.z /= vertices.size();
+		current = std::make_shared<const Extent>(Extent{Bound(vertices), mean});
+		std::atomic_store(&extent, current);
+	}
+	return current;
+}
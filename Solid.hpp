@@ -2,9 +2,14 @@
 #define __SOLID__
 
 #include<iostream>
+#include<memory>
 #include<vector>
 #include"Point3f.hpp"
 
+class SolidView;
+class TriangleTree;
+class Bound;
+
 /*import java.io.BufferedReader;
 import java.io.File;
 import java.io.FileReader;
@@ -15,6 +20,12 @@ import com.sun.j3d.utils.geometry.NormalGenerator;*/
 
 /**
  * Class representing a 3D solid.
+ * 
+ * <br><br>The geometrical transformations don't move the vertices: they are composed
+ * into a pending affine transform, applied in a single pass the first time the
+ * vertices are read (e.g. by Object3D) or by applyTransform(). The bound of a
+ * transformed solid is taken from the transformed corners of the bound of its stored
+ * vertices, which may be a bit larger than the bound of the transformed vertices.
  *  
  * @author Danilo Balby Silva Castanheira (danbalby@yahoo.com)
  * Translated to C++ by akatsia-games on github.com
@@ -28,8 +39,12 @@ public:
 
 	Solid(std::basic_istream<char>& solidFile, Colour3f color);
 
+	Solid(const SolidView& view, Colour3f color);
+
 	void write(std::basic_ostream<char>& solidFile) const;
 
+	void writeBinary(std::basic_ostream<char>& solidFile) const;
+
 	const std::vector<Point3f>& getVertices() const;
 	std::vector<Point3f>& getVertices();
 
@@ -47,6 +62,8 @@ public:
 
 	void setData(const std::vector<Point3f>& vertices, const std::vector<int>& indices, Colour3f color);
 
+	void setData(std::vector<Point3f>&& vertices, std::vector<int>&& indices, std::vector<Colour3f>&& colors);
+
 	void translate(double dx, double dy, double dz);
 
 	void rotate(double dx, double dy);
@@ -55,9 +72,24 @@ public:
 
 	void scale(double dx, double dy, double dz);
 
-	Vector3f intersectRay(Vector3f position, Vector3f direction);
+	bool transform(const double matrix[4][4]);
+
+	bool hasTransform() const;
+
+	void applyTransform() const;
+
+	Bound getBound() const;
+
+	Vector3f intersectRay(Vector3f position, Vector3f direction) const;
+
+	bool intersectRay(const Vector3f& position, const Vector3f& direction, double& distance, int& triangle) const;
+
+	void intersectRays(const std::vector<Vector3f>& positions, const std::vector<Vector3f>& directions, std::vector<double>& distances, std::vector<int>& triangles) const;
 
 protected:
+	struct Transform;
+	struct Extent;
+
 	static double signedTriangleVolume(Point3f p1, Point3f p2, Point3f p3);
 
 	void setInitialFeatures();
@@ -66,14 +98,33 @@ protected:
 
 	void loadCoordinateFile(std::basic_istream<char>& solidFile, Colour3f color);
 
-	Point3f getMean();
+	Point3f getMean() const;
+
+	void composeTransform(const double matrix[3][4]);
+
+	std::shared_ptr<const Extent> getExtent() const;
+
+	std::shared_ptr<const TriangleTree> getRayTree() const;
+
+	static double getEntryDistance(const Bound& bound, const Vector3f& position, const Vector3f& direction, double maxDistance);
+
+	static double getHitDistance(const Vector3f& position, const Vector3f& direction, const Point3f& p1, const Point3f& p2, const Point3f& p3);
 	
 	/** array of indices for the vertices from the 'vertices' attribute */
 	std::vector<int> indices;
-	/** array of points defining the solid's vertices */
-	std::vector<Point3f> vertices;
+	/** array of points defining the solid's vertices, before the pending transform */
+	mutable std::vector<Point3f> vertices;
 	/** array of color defining the vertices colors */
 	std::vector<Colour3f> colors;
+	/** hierarchy over the triangles for the ray queries, built on the first one and shared by copies */
+	mutable std::shared_ptr<const TriangleTree> rayTree;
+	/** affine transform not applied to the vertices yet, null if there is none */
+	mutable std::shared_ptr<const Transform> pendingTransform;
+	/** bound and mean of the vertices as stored, computed on the first need */
+	mutable std::shared_ptr<const Extent> extent;
+
+	/** distance under which a ray is taken to start on the triangle it hits, which is skipped */
+	constexpr static const double RAY_TOL = 1e-10;
 };
 
 #endif //__SOLID__
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include "SolidView.hpp"
+#include <cstring>
+
+/**
+ * Non-owning view over a solid stored in the binary mesh format, mapped in memory.
+ * 
+ * @author akatsia-games on github.com
+ */
+
+const char SolidView::MAGIC[8] = {'U','B','B','M','E','S','H','\0'};
+
+//---------------------------------CONSTRUCTORS---------------------------------//
+
+/**
+ * Maps a binary mesh file. The header and the file size are checked, the indices 
+ * are not (Solid checks them when it copies the view). Files can only be mapped on
+ * little endian hosts. Use isValid() to check if the file could be used.
+ * 
+ * @param path file path
+ */
+SolidView::SolidView(const std::string& path)
+	:file(path)
+	,numVertices(0)
+	,numTriangles(0)
+	,vertices(nullptr)
+	,indices(nullptr)
+	,colors(nullptr)
+{
+	//the arrays are used as they are stored, in little endian
+	const uint16_t one = 1;
+	unsigned char first;
+	memcpy(&first, &one, 1);
+	if(first!=1 || !file.isOpen() || file.getSize()<HEADER_SIZE)
+	{
+		return;
+	}
+	
+	const char* data = file.getData();
+	uint32_t version, flags;
+	uint64_t vertexCount, triangleCount;
+	memcpy(&version, data+8, sizeof(version));
+	memcpy(&flags, data+12, sizeof(flags));
+	memcpy(&vertexCount, data+16, sizeof(vertexCount));
+	memcpy(&triangleCount, data+24, sizeof(triangleCount));
+	
+	if(memcmp(data, MAGIC, sizeof(MAGIC))!=0 || version!=VERSION || vertexCount>INT32_MAX || triangleCount>INT32_MAX/3)
+	{
+		return;
+	}
+	
+	size_t verticesSize = vertexCount*sizeof(Point3f);
+	size_t indicesSize = getIndicesSize(triangleCount);
+	size_t colorsSize = (flags&HAS_COLORS) ? vertexCount*sizeof(Colour3f) : 0;
+	if(file.getSize()!=HEADER_SIZE+verticesSize+indicesSize+colorsSize)
+	{
+		return;
+	}
+	
+	numVertices = vertexCount;
+	numTriangles = triangleCount;
+	vertices = (const Point3f*)(data+HEADER_SIZE);
+	indices = (const int*)(data+HEADER_SIZE+verticesSize);
+	if(flags&HAS_COLORS)
+	{
+		colors = (const Colour3f*)(data+HEADER_SIZE+verticesSize+indicesSize);
+	}
+}
+
+//-------------------------------------GETS-------------------------------------//
+
+/**
+ * Checks if the file was mapped and has a valid header
+ * 
+ * @return true if the arrays can be used, false otherwise
+ */
+bool SolidView::isValid() const
+{
+	return vertices!=nullptr;
+}
+
+/**
+ * Gets the number of vertices
+ * 
+ * @return number of vertices
+ */
+int SolidView::getNumVertices() const
+{
+	return numVertices;
+}
+
+/**
+ * Gets the number of triangles
+ * 
+ * @return number of triangles
+ */
+int SolidView::getNumTriangles() const
+{
+	return numTriangles;
+}
+
+/**
+ * Gets the vertex coordinates
+ * 
+ * @return array of getNumVertices() points
+ */
+const Point3f* SolidView::getVertices() const
+{
+	return vertices;
+}
+
+/**
+ * Gets the vertex indices
+ * 
+ * @return array of 3*getNumTriangles() indices
+ */
+const int* SolidView::getIndices() const
+{
+	return indices;
+}
+
+/**
+ * Gets the vertex colors
+ * 
+ * @return array of getNumVertices() colors, null if the file has no colors
+ */
+const Colour3f* SolidView::getColors() const
+{
+	return colors;
+}
+
+/**
+ * Gets the size of the indices array, padding included
+ * 
+ * @param numTriangles number of triangles
+ * @return size in bytes
+ */
+size_t SolidView::getIndicesSize(uint64_t numTriangles)
+{
+	size_t size = numTriangles*3*sizeof(int32_t);
+	return (size+7)&~(size_t)7;
+}
@@ -0,0 +1,75 @@
+#ifndef __SOLID_VIEW__
+#define __SOLID_VIEW__
+
+#include<cstdint>
+#include<string>
+#include"Point3f.hpp"
+#include"MappedFile.hpp"
+
+/**
+ * Non-owning view over a solid stored in the binary mesh format, mapped in memory.
+ * 
+ * <br><br>The format is made of a 32 bytes header followed by packed arrays, so the
+ * arrays are used straight from the mapping, with no parsing and no copy:
+ * 
+ * <br><br>char[8]  magic "UBBMESH"
+ * <br>uint32   version
+ * <br>uint32   flags (HAS_COLORS)
+ * <br>uint64   number of vertices
+ * <br>uint64   number of triangles
+ * <br>double[3*vertices]  vertex coordinates
+ * <br>int32[3*triangles]  vertex indices, padded with zeros to a multiple of 8 bytes
+ * <br>double[3*vertices]  vertex colors, only if HAS_COLORS is set
+ * 
+ * <br><br>All values are little endian. Files are written by Solid::writeBinary().
+ * 
+ * @author akatsia-games on github.com
+ */
+class SolidView
+{
+public:
+	/** format version written by this library */
+	static const uint32_t VERSION = 1;
+	/** flag set when the file contains vertex colors */
+	static const uint32_t HAS_COLORS = 1;
+	/** size of the header in bytes */
+	static const size_t HEADER_SIZE = 32;
+	/** magic bytes at the start of the file */
+	static const char MAGIC[8];
+
+	SolidView(const std::string& path);
+
+	bool isValid() const;
+
+	int getNumVertices() const;
+
+	int getNumTriangles() const;
+
+	const Point3f* getVertices() const;
+
+	const int* getIndices() const;
+
+	const Colour3f* getColors() const;
+
+	static size_t getIndicesSize(uint64_t numTriangles);
+
+private:
+	/** the mapped file */
+	MappedFile file;
+	/** number of vertices, 0 if the file is invalid */
+	int numVertices;
+	/** number of triangles, 0 if the file is invalid */
+	int numTriangles;
+	/** vertex coordinates inside the mapping */
+	const Point3f* vertices;
+	/** vertex indices inside the mapping */
+	const int* indices;
+	/** vertex colors inside the mapping, null if the file has none */
+	const Colour3f* colors;
+};
+
+static_assert(sizeof(Point3f)==3*sizeof(double), "Point3f must be packed to be mapped");
+static_assert(sizeof(Colour3f)==3*sizeof(double), "Colour3f must be packed to be mapped");
+static_assert(sizeof(int)==sizeof(int32_t), "indices are stored as 32 bit integers");
+
+#endif //__SOLID_VIEW__
@@ -0,0 +1,64 @@
+#include "SolidWriter.hpp"
+#include "OutputBuffer.hpp"
+#include "Solid.hpp"
+#include "StlFile.hpp"
+#include "ObjFile.hpp"
+#include "PlyFile.hpp"
+#include "Trace.hpp"
+#include <fstream>
+
+/**
+ * Writes solids in any of the formats the library reads, through a large OutputBuffer.
+ * 
+ * @author akatsia-games on github.com
+ */
+
+/**
+ * Writes a solid into a file
+ * 
+ * @param solid solid to be written
+ * @param path file path
+ * @param format file format (COORDINATES, BINARY, STL, STL_ASCII, OBJ, PLY or PLY_ASCII)
+ * @param asynchronous true to write the blocks from a background thread
+ * @return true if the file was written, false otherwise
+ */
+bool SolidWriter::save(const Solid& solid, const std::string& path, int format, bool asynchronous)
+{
+	TRACE_SCOPE("SolidWriter::save");
+	std::ofstream file(path, std::ios::binary);
+	if(!file)
+	{
+		return false;
+	}
+	return write(solid, file, format, asynchronous);
+}
+
+/**
+ * Writes a solid into a stream
+ * 
+ * @param solid solid to be written
+ * @param output stream, opened in binary mode for binary formats
+ * @param format file format (COORDINATES, BINARY, STL, STL_ASCII, OBJ, PLY or PLY_ASCII)
+ * @param asynchronous true to write the blocks from a background thread
+ * @return true if the solid was written, false if the format is unknown or the stream failed
+ */
+bool SolidWriter::write(const Solid& solid, std::basic_ostream<char>& output, int format, bool asynchronous)
+{
+	TRACE_SCOPE("SolidWriter::write");
+	{
+		OutputBuffer buffer(output, asynchronous);
+		std::ostream stream(&buffer);
+		switch(format)
+		{
+			case COORDINATES: solid.write(stream); break;
+			case BINARY: solid.writeBinary(stream); break;
+			case STL: StlFile::write(solid, stream, true); break;
+			case STL_ASCII: StlFile::write(solid, stream, false); break;
+			case OBJ: ObjFile::write(solid, stream); break;
+			case PLY: PlyFile::write(solid, stream, true); break;
+			case PLY_ASCII: PlyFile::write(solid, stream, false); break;
+			default: return false;
+		}
+	}
+	return (bool)output;
+}
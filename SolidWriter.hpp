@@ -0,0 +1,39 @@
+#ifndef __SOLID_WRITER__
+#define __SOLID_WRITER__
+
+#include<iostream>
+#include<string>
+
+class Solid;
+
+/**
+ * Writes solids in any of the formats the library reads, through a large OutputBuffer.
+ * 
+ * <br><br>With asynchronous writeback the blocks are written by a background thread while
+ * the next ones are being formatted.
+ * 
+ * @author akatsia-games on github.com
+ */
+class SolidWriter
+{
+public:
+	/** coordinates file (see Solid::write) */
+	static const int COORDINATES = 1;
+	/** binary mesh file (see SolidView) */
+	static const int BINARY = 2;
+	/** binary STL file */
+	static const int STL = 3;
+	/** ASCII STL file */
+	static const int STL_ASCII = 4;
+	/** OBJ file */
+	static const int OBJ = 5;
+	/** binary PLY file */
+	static const int PLY = 6;
+	/** ASCII PLY file */
+	static const int PLY_ASCII = 7;
+
+	static bool save(const Solid& solid, const std::string& path, int format, bool asynchronous = false);
+
+	static bool write(const Solid& solid, std::basic_ostream<char>& output, int format, bool asynchronous = false);
+};
+#endif //__SOLID_WRITER__
@@ -0,0 +1,442 @@
+#include "StlFile.hpp"
+#include "Solid.hpp"
+#include "Trace.hpp"
+#include <charconv>
+#include <cstring>
+#include <fstream>
+
+/**
+ * Reader and writer for binary and ASCII STL files.
+ * 
+ * @author akatsia-games on github.com
+ */
+
+//---------------------------------------READ-----------------------------------//
+
+/**
+ * Loads an STL file into a solid
+ * 
+ * @param path file path
+ * @param solid solid receiving the data
+ * @param color solid color
+ * @return true if the file was read, false if it couldn't be opened or is malformed
+ */
+bool StlFile::load(const std::string& path, Solid& solid, Colour3f color)
+{
+	TRACE_SCOPE("StlFile::load");
+	std::ifstream stlFile(path, std::ios::binary);
+	if(!stlFile)
+	{
+		return false;
+	}
+	return read(stlFile, solid, color);
+}
+
+/**
+ * Reads a binary or ASCII STL stream into a solid. Binary files starting with "solid"
+ * are recognised when the stream size can be checked against the triangle count, or
+ * read as binary when they fail as ASCII and the stream can be rewound.
+ * 
+ * @param stlFile stream opened in binary mode
+ * @param solid solid receiving the data, left untouched if the stream is malformed
+ * @param color solid color
+ * @return true if the stream was read, false if it is malformed
+ */
+bool StlFile::read(std::basic_istream<char>& stlFile, Solid& solid, Colour3f color)
+{
+	TRACE_SCOPE("StlFile::read");
+	char header[HEADER_SIZE+sizeof(uint32_t)];
+	stlFile.read(header, sizeof(header));
+	size_t headerSize = stlFile.gcount();
+	
+	uint32_t numTriangles = 0;
+	if(headerSize==sizeof(header))
+	{
+		memcpy(&numTriangles, header+HEADER_SIZE, sizeof(numTriangles));
+	}
+	
+	bool ascii = headerSize>=5 && strncmp(header, "solid", 5)==0;
+	if(ascii && headerSize==sizeof(header))
+	{
+		std::streampos current = stlFile.tellg();
+		if(current!=std::streampos(-1))
+		{
+			stlFile.seekg(0, std::ios::end);
+			std::streampos size = stlFile.tellg();
+			stlFile.seekg(current);
+			if(size==std::streampos(sizeof(header)+(uint64_t)RECORD_SIZE*numTriangles))
+			{
+				ascii = false;
+			}
+		}
+	}
+	
+	std::vector<Point3f> vertices;
+	std::vector<int> indices;
+	bool success;
+	if(ascii)
+	{
+		stlFile.clear();
+		std::streampos current = stlFile.tellg();
+		success = readAscii(stlFile, header, headerSize, vertices, indices);
+		if(!success && headerSize==sizeof(header) && current!=std::streampos(-1))
+		{
+			//a binary file whose header starts with "solid" and whose size is off its triangle count
+			vertices.clear();
+			indices.clear();
+			stlFile.clear();
+			stlFile.seekg(current);
+			success = readBinary(stlFile, numTriangles, vertices, indices);
+		}
+	}
+	else
+	{
+		success = (headerSize==sizeof(header)) && readBinary(stlFile, numTriangles, vertices, indices);
+	}
+	if(!success)
+	{
+		return false;
+	}
+	
+	std::vector<Colour3f> colors(vertices.size(), color);
+	solid.setData(std::move(vertices), std::move(indices), std::move(colors));
+	return true;
+}
+
+//--------------------------------------WRITE-----------------------------------//
+
+/**
+ * Writes a solid as an STL file. Coordinates are stored in single precision, as the
+ * format requires.
+ * 
+ * @param solid solid to be written
+ * @param stlFile stream, opened in binary mode for binary files
+ * @param binary true for a binary file, false for an ASCII file
+ */
+void StlFile::write(const Solid& solid, std::basic_ostream<char>& stlFile, bool binary)
+{
+	TRACE_SCOPE("StlFile::write");
+	if(binary)
+	{
+		writeBinary(solid, stlFile);
+	}
+	else
+	{
+		writeAscii(solid, stlFile);
+	}
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/**
+ * Hashes the exact coordinates of a vertex
+ * 
+ * @param point vertex position
+ * @return hash value
+ */
+size_t StlFile::PointHash::operator()(const Point3f& point) const
+{
+	//adding zero turns -0 into +0, so equal coordinates hash equally
+	double coordinates[3] = {point.x+0.0, point.y+0.0, point.z+0.0};
+	uint64_t bits[3];
+	memcpy(bits, coordinates, sizeof(bits));
+	uint64_t hash = bits[0]*0x9E3779B97F4A7C15ULL;
+	hash = (hash^(hash>>29)^bits[1])*0xBF58476D1CE4E5B9ULL;
+	hash = (hash^(hash>>32)^bits[2])*0x94D049BB133111EBULL;
+	return hash^(hash>>31);
+}
+
+/**
+ * Compares the exact coordinates of two vertices
+ * 
+ * @param first a vertex position
+ * @param second a vertex position
+ * @return true if all coordinates are equal, false otherwise
+ */
+bool StlFile::PointEquals::operator()(const Point3f& first, const Point3f& second) const
+{
+	return first.x==second.x && first.y==second.y && first.z==second.z;
+}
+
+/**
+ * Reads the triangle records of a binary STL stream, chunk by chunk
+ * 
+ * @param stlFile stream positioned after the header
+ * @param numTriangles number of triangles announced by the header
+ * @param vertices welded vertices
+ * @param indices triangle indices
+ * @return true if all triangles were read, false otherwise
+ */
+bool StlFile::readBinary(std::basic_istream<char>& stlFile, uint32_t numTriangles, std::vector<Point3f>& vertices, std::vector<int>& indices)
+{
+	//the header count is trusted for the reservations only as far as the stream holds
+	//the records, and streams whose size can't be checked reserve a single chunk
+	uint32_t numReserved = std::min<uint32_t>(CHUNK_TRIANGLES, numTriangles);
+	std::streampos current = stlFile.tellg();
+	if(current!=std::streampos(-1))
+	{
+		stlFile.seekg(0, std::ios::end);
+		std::streampos size = stlFile.tellg();
+		stlFile.clear();
+		stlFile.seekg(current);
+		if(size!=std::streampos(-1))
+		{
+			if(size-current<(std::streamoff)((uint64_t)RECORD_SIZE*numTriangles))
+			{
+				return false;
+			}
+			numReserved = numTriangles;
+		}
+	}
+	
+	//closed meshes have about half as many vertices as triangles
+	VertexMap vertexMap(numReserved/2+1);
+	vertices.reserve(numReserved/2+1);
+	indices.reserve(3*(size_t)numReserved);
+	
+	std::vector<char> chunk(CHUNK_TRIANGLES*RECORD_SIZE);
+	for(uint32_t done=0;done<numTriangles;)
+	{
+		uint32_t count = std::min<uint32_t>(CHUNK_TRIANGLES, numTriangles-done);
+		if(!stlFile.read(chunk.data(), count*RECORD_SIZE))
+		{
+			return false;
+		}
+		for(uint32_t i=0;i<count;i++)
+		{
+			//skip the normal, read the corners, ignore the attributes
+			const char* record = chunk.data()+i*RECORD_SIZE+3*sizeof(float);
+			float coordinates[9];
+			memcpy(coordinates, record, sizeof(coordinates));
+			Point3f corners[3] = 
+			{
+				{(double)coordinates[0], (double)coordinates[1], (double)coordinates[2]},
+				{(double)coordinates[3], (double)coordinates[4], (double)coordinates[5]},
+				{(double)coordinates[6], (double)coordinates[7], (double)coordinates[8]}
+			};
+			addTriangle(corners, vertexMap, vertices, indices);
+		}
+		done += count;
+	}
+	return true;
+}
+
+/**
+ * Reads the vertex lines of an ASCII STL stream, block by block
+ * 
+ * @param stlFile stream
+ * @param start characters already read from the stream
+ * @param startSize number of characters already read
+ * @param vertices welded vertices
+ * @param indices triangle indices
+ * @return true if every vertex line is valid, the vertices form whole triangles, there
+ * is at least one of them and the stream ends the solid with "endsolid"
+ */
+bool StlFile::readAscii(std::basic_istream<char>& stlFile, const char* start, size_t startSize, std::vector<Point3f>& vertices, std::vector<int>& indices)
+{
+	VertexMap vertexMap;
+	std::string block(start, startSize);
+	std::vector<char> buffer(CHUNK_TRIANGLES*RECORD_SIZE);
+	Point3f corners[3];
+	int numCorners = 0;
+	int numTriangles = 0;
+	bool ended = false;
+	bool endOfFile = false;
+	
+	while(!endOfFile)
+	{
+		stlFile.read(buffer.data(), buffer.size());
+		endOfFile = stlFile.gcount()==0;
+		block.append(buffer.data(), stlFile.gcount());
+		
+		//parse the complete lines of the block, the last one too at the end of the file
+		size_t lineStart = 0;
+		for(size_t lineEnd=block.find('\n');lineEnd!=std::string::npos || (endOfFile && lineStart<block.size());lineEnd=block.find('\n', lineStart))
+		{
+			if(lineEnd==std::string::npos)
+			{
+				lineEnd = block.size();
+			}
+			const char* position = block.data()+lineStart;
+			const char* end = block.data()+lineEnd;
+			lineStart = lineEnd+1;
+			
+			while(position<end && (*position==' ' || *position=='\t'))
+			{
+				position++;
+			}
+			if(end-position>=8 && strncmp(position, "endsolid", 8)==0)
+			{
+				ended = true;
+				continue;
+			}
+			if(end-position<6 || strncmp(position, "vertex", 6)!=0)
+			{
+				continue;
+			}
+			position += 6;
+			
+			double coordinates[3];
+			for(double& coordinate : coordinates)
+			{
+				while(position<end && (*position==' ' || *position=='\t'))
+				{
+					position++;
+				}
+				if(position<end && *position=='+')
+				{
+					position++;
+				}
+				std::from_chars_result result = std::from_chars(position, end, coordinate);
+				if(result.ec!=std::errc())
+				{
+					return false;
+				}
+				position = result.ptr;
+			}
+			
+			corners[numCorners++] = {coordinates[0], coordinates[1], coordinates[2]};
+			if(numCorners==3)
+			{
+				addTriangle(corners, vertexMap, vertices, indices);
+				numCorners = 0;
+				numTriangles++;
+			}
+		}
+		block.erase(0, std::min(lineStart, block.size()));
+	}
+	return numCorners==0 && numTriangles>0 && ended;
+}
+
+/**
+ * Welds the corners of a triangle with the vertices read before and adds it
+ * 
+ * @param corners triangle corners
+ * @param vertexMap vertices read until now and their indices
+ * @param vertices welded vertices
+ * @param indices triangle indices
+ */
+void StlFile::addTriangle(const Point3f corners[3], VertexMap& vertexMap, std::vector<Point3f>& vertices, std::vector<int>& indices)
+{
+	int triangle[3];
+	for(int i=0;i<3;i++)
+	{
+		auto inserted = vertexMap.emplace(corners[i], (int)vertices.size());
+		if(inserted.second)
+		{
+			vertices.push_back(corners[i]);
+		}
+		triangle[i] = inserted.first->second;
+	}
+	
+	if(triangle[0]!=triangle[1] && triangle[1]!=triangle[2] && triangle[2]!=triangle[0])
+	{
+		indices.insert(indices.end(), triangle, triangle+3);
+	}
+}
+
+/**
+ * Writes a binary STL stream, chunk by chunk
+ * 
+ * @param solid solid to be written
+ * @param stlFile stream opened in binary mode
+ */
+void StlFile::writeBinary(const Solid& solid, std::basic_ostream<char>& stlFile)
+{
+	const std::vector<Point3f>& vertices = solid.getVertices();
+	const std::vector<int>& indices = solid.getIndices();
+	uint32_t numTriangles = indices.size()/3;
+	
+	//the header must not start with "solid", or readers take it for ASCII
+	char header[HEADER_SIZE];
+	memset(header, ' ', sizeof(header));
+	memcpy(header, "UnBBoolean binary STL", 21);
+	stlFile.write(header, sizeof(header));
+	stlFile.write((const char*)&numTriangles, sizeof(numTriangles));
+	
+	std::vector<char> chunk(CHUNK_TRIANGLES*RECORD_SIZE, 0);
+	for(uint32_t done=0;done<numTriangles;)
+	{
+		uint32_t count = std::min<uint32_t>(CHUNK_TRIANGLES, numTriangles-done);
+		for(uint32_t i=0;i<count;i++)
+		{
+			const Point3f& p1 = vertices[indices[3*(done+i)]];
+			const Point3f& p2 = vertices[indices[3*(done+i)+1]];
+			const Point3f& p3 = vertices[indices[3*(done+i)+2]];
+			Vector3f edge1 = {p2.x-p1.x, p2.y-p1.y, p2.z-p1.z};
+			Vector3f edge2 = {p3.x-p1.x, p3.y-p1.y, p3.z-p1.z};
+			Vector3f normal;
+			normal.cross(edge1, edge2);
+			if(normal.length()>0)
+			{
+				normal.normalize();
+			}
+			
+			float values[12] = 
+			{
+				(float)normal.x, (float)normal.y, (float)normal.z,
+				(float)p1.x, (float)p1.y, (float)p1.z,
+				(float)p2.x, (float)p2.y, (float)p2.z,
+				(float)p3.x, (float)p3.y, (float)p3.z
+			};
+			memcpy(chunk.data()+i*RECORD_SIZE, values, sizeof(values));
+		}
+		stlFile.write(chunk.data(), count*RECORD_SIZE);
+		done += count;
+	}
+}
+
+/**
+ * Writes an ASCII STL stream, chunk by chunk
+ * 
+ * @param solid solid to be written
+ * @param stlFile stream
+ */
+void StlFile::writeAscii(const Solid& solid, std::basic_ostream<char>& stlFile)
+{
+	const std::vector<Point3f>& vertices = solid.getVertices();
+	const std::vector<int>& indices = solid.getIndices();
+	
+	std::string chunk = "solid UnBBoolean\n";
+	auto append = [&chunk](const char* prefix, double x, double y, double z)
+	{
+		char number[32];
+		chunk += prefix;
+		for(double value : {x, y, z})
+		{
+			chunk += ' ';
+			chunk.append(number, std::to_chars(number, number+sizeof(number), (float)value).ptr);
+		}
+		chunk += '\n';
+	};
+	
+	for(size_t i=0;i+2<indices.size();i+=3)
+	{
+		const Point3f& p1 = vertices[indices[i]];
+		const Point3f& p2 = vertices[indices[i+1]];
+		const Point3f& p3 = vertices[indices[i+2]];
+		Vector3f edge1 = {p2.x-p1.x, p2.y-p1.y, p2.z-p1.z};
+		Vector3f edge2 = {p3.x-p1.x, p3.y-p1.y, p3.z-p1.z};
+		Vector3f normal;
+		normal.cross(edge1, edge2);
+		if(normal.length()>0)
+		{
+			normal.normalize();
+		}
+		
+		append("facet normal", normal.x, normal.y, normal.z);
+		chunk += "outer loop\n";
+		append("vertex", p1.x, p1.y, p1.z);
+		append("vertex", p2.x, p2.y, p2.z);
+		append("vertex", p3.x, p3.y, p3.z);
+		chunk += "endloop\nendfacet\n";
+		
+		if(chunk.size()>CHUNK_TRIANGLES*RECORD_SIZE)
+		{
+			stlFile.write(chunk.data(), chunk.size());
+			chunk.clear();
+		}
+	}
+	chunk += "endsolid UnBBoolean\n";
+	stlFile.write(chunk.data(), chunk.size());
+}
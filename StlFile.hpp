@@ -0,0 +1,63 @@
+#ifndef __STL_FILE__
+#define __STL_FILE__
+
+#include<cstdint>
+#include<iostream>
+#include<string>
+#include<vector>
+#include<unordered_map>
+#include"Point3f.hpp"
+
+class Solid;
+
+/**
+ * Reader and writer for binary and ASCII STL files.
+ * 
+ * <br><br>Triangles are streamed in fixed size chunks and their corners are welded on
+ * the fly through a hash of their exact coordinates, so the indexed arrays of the solid
+ * are produced directly and the only memory used besides them is the chunk buffer and
+ * the hash of the distinct vertices. Triangles whose corners weld together are dropped.
+ * 
+ * @author akatsia-games on github.com
+ */
+class StlFile
+{
+public:
+	static bool load(const std::string& path, Solid& solid, Colour3f color);
+
+	static bool read(std::basic_istream<char>& stlFile, Solid& solid, Colour3f color);
+
+	static void write(const Solid& solid, std::basic_ostream<char>& stlFile, bool binary = true);
+
+private:
+	/** hash of the exact coordinates of a vertex */
+	struct PointHash
+	{
+		size_t operator()(const Point3f& point) const;
+	};
+	/** exact comparison of the coordinates of two vertices */
+	struct PointEquals
+	{
+		bool operator()(const Point3f& first, const Point3f& second) const;
+	};
+	/** vertices read until now and their indices */
+	typedef std::unordered_map<Point3f, int, PointHash, PointEquals> VertexMap;
+
+	static bool readBinary(std::basic_istream<char>& stlFile, uint32_t numTriangles, std::vector<Point3f>& vertices, std::vector<int>& indices);
+
+	static bool readAscii(std::basic_istream<char>& stlFile, const char* start, size_t startSize, std::vector<Point3f>& vertices, std::vector<int>& indices);
+
+	static void addTriangle(const Point3f corners[3], VertexMap& vertexMap, std::vector<Point3f>& vertices, std::vector<int>& indices);
+
+	static void writeBinary(const Solid& solid, std::basic_ostream<char>& stlFile);
+
+	static void writeAscii(const Solid& solid, std::basic_ostream<char>& stlFile);
+
+	/** size of the binary header */
+	static const int HEADER_SIZE = 80;
+	/** size of a binary triangle record */
+	static const int RECORD_SIZE = 50;
+	/** number of triangles read or written at once */
+	static const int CHUNK_TRIANGLES = 4096;
+};
+#endif //__STL_FILE__
@@ -0,0 +1,538 @@
+#include "StockSimulator.hpp"
+#include "BooleanModeller.hpp"
+#include "Object3D.hpp"
+#include "WindingNumber.hpp"
+#include "Parallel.hpp"
+#include "Trace.hpp"
+#include "VertexWelder.hpp"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+/**
+ * Material removal of a tool following a path through a stock.
+ *
+ * @author akatsia-games on github.com
+ */
+
+/** directions of the rays telling if a point is inside, the next one taken when a ray is ambiguous */
+static const Vector3f RAY_DIRECTIONS[3] = {
+	{0.2672612419124244, 0.5345224838248488, 0.8017837257372732},
+	{-0.8017837257372732, 0.2672612419124244, 0.5345224838248488},
+	{0.5345224838248488, -0.8017837257372732, 0.2672612419124244}};
+
+//---------------------------------CONSTRUCTORS---------------------------------//
+
+/**
+ * Constructs a simulation starting from a stock
+ *
+ * @param stock solid the tool is substracted from
+ */
+StockSimulator::StockSimulator(const Solid& stock)
+	:vertices(stock.getVertices())
+	,colors(stock.getColors())
+	,triangles(stock.getIndices())
+{
+	rebuildIndex();
+}
+
+//-------------------------------------SETS-------------------------------------//
+
+/**
+ * Substracts the tool, as placed for a step of the path, from the stock
+ *
+ * @param tool solid substracted (see Solid::transform to place it)
+ */
+void StockSimulator::subtract(const Solid& tool)
+{
+	TRACE_SCOPE("StockSimulator::subtract");
+	numSteps++;
+	numNearFaces = 0;
+	Bound toolBound = tool.getBound();
+	if(tool.isEmpty() || getNumTriangles()==0 || !toolBound.overlap(bound))
+	{
+		return;
+	}
+
+	//stock triangles overlapping the tool bound
+	std::vector<int> near;
+	Point3f toolMin = toolBound.getMin();
+	Point3f toolMax = toolBound.getMax();
+	int min[3], max[3];
+	getCellRange(Bound(std::vector<Point3f>{Point3f(toolMin.x-VertexWelder::TOL, toolMin.y-VertexWelder::TOL, toolMin.z-VertexWelder::TOL), Point3f(toolMax.x+VertexWelder::TOL, toolMax.y+VertexWelder::TOL, toolMax.z+VertexWelder::TOL)}), min, max);
+	for(int z=min[2];z<=max[2];z++)
+	{
+		for(int y=min[1];y<=max[1];y++)
+		{
+			for(int x=min[0];x<=max[0];x++)
+			{
+				for(int triangle : cells[(z*dims[1]+y)*dims[0]+x])
+				{
+					if(gathered[triangle]==numSteps)
+					{
+						continue;
+					}
+					gathered[triangle] = numSteps;
+					const int* corners = &triangles[3*triangle];
+					if(Bound(vertices[corners[0]], vertices[corners[1]], vertices[corners[2]]).overlap(toolBound))
+					{
+						near.push_back(triangle);
+					}
+				}
+			}
+		}
+	}
+	std::sort(near.begin(), near.end());
+	numNearFaces = near.size();
+
+	//solid made of the near triangles
+	std::vector<int> nearVertices;
+	std::unordered_map<int,int> nearVertexOf;
+	std::vector<Point3f> nearPositions;
+	std::vector<Colour3f> nearColors;
+	std::vector<int> nearIndices;
+	for(int triangle : near)
+	{
+		for(int corner=0;corner<3;corner++)
+		{
+			int vertex = triangles[3*triangle+corner];
+			auto inserted = nearVertexOf.insert({vertex, (int)nearVertices.size()});
+			if(inserted.second)
+			{
+				nearVertices.push_back(vertex);
+				nearPositions.push_back(vertices[vertex]);
+				nearColors.push_back(colors[vertex]);
+			}
+			nearIndices.push_back(inserted.first->second);
+		}
+	}
+	Solid nearSolid;
+	nearSolid.setData(std::move(nearPositions), std::move(nearIndices), std::move(nearColors));
+
+	//the near triangles are split and classified by the tool
+	Object3D nearObject(nearSolid);
+	Object3D toolObject(tool);
+	if(!near.empty())
+	{
+		nearObject.splitFacesBatched(toolObject);
+		toolObject.splitFacesBatched(nearObject);
+		WindingNumber toolWinding(toolObject);
+		nearObject.classifyFaces(toolWinding);
+	}
+
+	//the tool faces are classified by the whole stock, before it changes, sampling both
+	//sides of each face as Face::windingNumberClassify
+	std::vector<char> inside(toolObject.getNumFaces(), 0);
+	Parallel::forEach(0, toolObject.getNumFaces(), [&](int i)
+	{
+		const Face& face = toolObject.getFace(i);
+		Point3f center((face.v1().x+face.v2().x+face.v3().x)/3.0, (face.v1().y+face.v2().y+face.v3().y)/3.0, (face.v1().z+face.v2().z+face.v3().z)/3.0);
+		Vector3f normal = face.getNormal();
+		double longestEdge = std::max(face.v1().getPosition().distance(face.v2().getPosition()),
+			std::max(face.v2().getPosition().distance(face.v3().getPosition()), face.v3().getPosition().distance(face.v1().getPosition())));
+		double offset = std::max(SAMPLE_OFFSET*longestEdge, MIN_SAMPLE_OFFSET);
+		inside[i] = isInside(Point3f(center.x+normal.x*offset, center.y+normal.y*offset, center.z+normal.z*offset)) &&
+			isInside(Point3f(center.x-normal.x*offset, center.y-normal.y*offset, center.z-normal.z*offset));
+	}, 16);
+
+	for(int triangle : near)
+	{
+		removeTriangle(triangle);
+	}
+
+	//the kept faces are welded to the vertices of the removed triangles and to each other
+	VertexWelder welder(vertices, colors);
+	for(int vertex : nearVertices)
+	{
+		welder.addVertex(vertex);
+	}
+
+	for(int objectNumber=0;objectNumber<2;objectNumber++)
+	{
+		const Object3D& object = objectNumber==0 ? nearObject : toolObject;
+		std::vector<int> weldedOf(object.getNumVertices(), -1);
+		for(int i=0;i<object.getNumFaces();i++)
+		{
+			const Face& face = object.getFace(i);
+			int orientation = objectNumber==0 ? BooleanModeller::getFaceOrientation(BooleanModeller::DIFFERENCE, true, face.getStatus()) : (inside[i] ? -1 : 0);
+			if(orientation==0)
+			{
+				continue;
+			}
+			int welded[3];
+			welder.weldFace(face, orientation, weldedOf, welded);
+			//faces thinner than the welding are dropped
+			if(welded[0]!=welded[1] && welded[1]!=welded[2] && welded[2]!=welded[0])
+			{
+				addTriangle(welded[0], welded[1], welded[2]);
+			}
+		}
+	}
+
+	if(numRemoved>getNumTriangles() || getNumTriangles()>REGRID_GROWTH*numIndexed)
+	{
+		rebuildIndex();
+	}
+}
+
+//-------------------------------------GETS-------------------------------------//
+
+/**
+ * Gets the stock, as left by the subtractions done
+ *
+ * @return stock solid, with the vertices no triangle uses left out
+ */
+Solid StockSimulator::getStock() const
+{
+	std::vector<int> vertexOf(vertices.size(), -1);
+	std::vector<Point3f> stockVertices;
+	std::vector<Colour3f> stockColors;
+	std::vector<int> stockIndices;
+	stockIndices.reserve(3*getNumTriangles());
+	for(size_t i=0;i<triangles.size();i+=3)
+	{
+		if(triangles[i]<0)
+		{
+			continue;
+		}
+		for(int corner=0;corner<3;corner++)
+		{
+			int vertex = triangles[i+corner];
+			if(vertexOf[vertex]<0)
+			{
+				vertexOf[vertex] = stockVertices.size();
+				stockVertices.push_back(vertices[vertex]);
+				stockColors.push_back(colors[vertex]);
+			}
+			stockIndices.push_back(vertexOf[vertex]);
+		}
+	}
+	Solid stock;
+	stock.setData(std::move(stockVertices), std::move(stockIndices), std::move(stockColors));
+	return stock;
+}
+
+/**
+ * Gets the number of stock triangles
+ *
+ * @return number of triangles
+ */
+int StockSimulator::getNumTriangles() const
+{
+	return triangles.size()/3-numRemoved;
+}
+
+/**
+ * Gets the number of stock triangles split and classified by the last subtraction
+ *
+ * @return number of triangles overlapping the bound of the last tool
+ */
+int StockSimulator::getNumNearFaces() const
+{
+	return numNearFaces;
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/**
+ * Drops the removed triangles and the unused vertices, and sizes the grid again for
+ * the remaining triangles
+ */
+void StockSimulator::rebuildIndex()
+{
+	TRACE_SCOPE("StockSimulator::rebuildIndex");
+	std::vector<int> vertexOf(vertices.size(), -1);
+	std::vector<Point3f> usedVertices;
+	std::vector<Colour3f> usedColors;
+	std::vector<int> liveTriangles;
+	liveTriangles.reserve(3*getNumTriangles());
+	for(size_t i=0;i<triangles.size();i+=3)
+	{
+		if(triangles[i]<0)
+		{
+			continue;
+		}
+		for(int corner=0;corner<3;corner++)
+		{
+			int vertex = triangles[i+corner];
+			if(vertexOf[vertex]<0)
+			{
+				vertexOf[vertex] = usedVertices.size();
+				usedVertices.push_back(vertices[vertex]);
+				usedColors.push_back(colors[vertex]);
+			}
+			liveTriangles.push_back(vertexOf[vertex]);
+		}
+	}
+	vertices.swap(usedVertices);
+	colors.swap(usedColors);
+	triangles.clear();
+	gathered.clear();
+	numRemoved = 0;
+	numIndexed = liveTriangles.size()/3;
+	bound = Bound(vertices);
+
+	//cells about as wide as the triangles, so that a cell holds a few of them
+	cells.clear();
+	dims[0] = dims[1] = dims[2] = 1;
+	if(!vertices.empty())
+	{
+		origin = bound.getMin();
+		Point3f max = bound.getMax();
+		double sides[3] = {max.x-origin.x, max.y-origin.y, max.z-origin.z};
+		double longest = std::max(sides[0], std::max(sides[1], sides[2]));
+		double volume = 1;
+		for(int axis=0;axis<3;axis++)
+		{
+			volume *= std::max(sides[axis], longest/MAX_DIMENSION);
+		}
+		cellSize = std::max(std::cbrt(volume/std::max(1, CELLS_PER_TRIANGLE*numIndexed)), longest/MAX_DIMENSION);
+		if(!(cellSize>0))
+		{
+			cellSize = 1;
+		}
+		for(int axis=0;axis<3;axis++)
+		{
+			dims[axis] = std::max(1, std::min(MAX_DIMENSION, (int)std::ceil(sides[axis]/cellSize)));
+		}
+	}
+	cells.resize(dims[0]*dims[1]*dims[2]);
+	for(size_t i=0;i<liveTriangles.size();i+=3)
+	{
+		addTriangle(liveTriangles[i], liveTriangles[i+1], liveTriangles[i+2]);
+	}
+}
+
+/**
+ * Adds a triangle to the stock and to the cells its bound overlaps
+ *
+ * @param v1 first vertex
+ * @param v2 second vertex
+ * @param v3 third vertex
+ */
+void StockSimulator::addTriangle(int v1, int v2, int v3)
+{
+	int triangle = triangles.size()/3;
+	triangles.push_back(v1);
+	triangles.push_back(v2);
+	triangles.push_back(v3);
+	gathered.push_back(-1);
+	int min[3], max[3];
+	getCellRange(Bound(vertices[v1], vertices[v2], vertices[v3]), min, max);
+	for(int z=min[2];z<=max[2];z++)
+	{
+		for(int y=min[1];y<=max[1];y++)
+		{
+			for(int x=min[0];x<=max[0];x++)
+			{
+				cells[(z*dims[1]+y)*dims[0]+x].push_back(triangle);
+			}
+		}
+	}
+}
+
+/**
+ * Removes a triangle from the stock and from its cells, leaving a hole in the array
+ *
+ * @param triangle triangle to remove
+ */
+void StockSimulator::removeTriangle(int triangle)
+{
+	int* corners = &triangles[3*triangle];
+	int min[3], max[3];
+	getCellRange(Bound(vertices[corners[0]], vertices[corners[1]], vertices[corners[2]]), min, max);
+	for(int z=min[2];z<=max[2];z++)
+	{
+		for(int y=min[1];y<=max[1];y++)
+		{
+			for(int x=min[0];x<=max[0];x++)
+			{
+				std::vector<int>& cell = cells[(z*dims[1]+y)*dims[0]+x];
+				auto it = std::find(cell.begin(), cell.end(), triangle);
+				if(it!=cell.end())
+				{
+					*it = cell.back();
+					cell.pop_back();
+				}
+			}
+		}
+	}
+	corners[0] = corners[1] = corners[2] = -1;
+	numRemoved++;
+}
+
+/**
+ * Gets the cells a bound overlaps, clamped to the grid
+ *
+ * @param bound bound to be covered
+ * @param min output, first cell along each axis
+ * @param max output, last cell along each axis
+ */
+void StockSimulator::getCellRange(const Bound& bound, int min[3], int max[3]) const
+{
+	Point3f low = bound.getMin();
+	Point3f high = bound.getMax();
+	double lows[3] = {low.x-origin.x, low.y-origin.y, low.z-origin.z};
+	double highs[3] = {high.x-origin.x, high.y-origin.y, high.z-origin.z};
+	for(int axis=0;axis<3;axis++)
+	{
+		min[axis] = (int)std::max(0.0, std::min((double)dims[axis]-1, std::floor(lows[axis]/cellSize)));
+		max[axis] = (int)std::max(0.0, std::min((double)dims[axis]-1, std::floor(highs[axis]/cellSize)));
+	}
+}
+
+/**
+ * Checks if a point is inside the stock, by the parity of the triangles crossed by a
+ * ray from it. Ambiguous rays, grazing an edge, are cast again in another direction.
+ *
+ * @param point point to be tested
+ * @return true if the point is inside the stock
+ */
+bool StockSimulator::isInside(const Point3f& point) const
+{
+	int crossings = 0;
+	for(const Vector3f& direction : RAY_DIRECTIONS)
+	{
+		bool ambiguous;
+		crossings = countCrossings(point, direction, ambiguous);
+		if(!ambiguous)
+		{
+			break;
+		}
+	}
+	return crossings%2==1;
+}
+
+/**
+ * Counts the stock triangles a ray crosses, walking the grid cells it goes through
+ * and counting each crossing on the cell it lies in.
+ *
+ * <br><br>See: J. Amanatides, A. Woo. "A Fast Voxel Traversal Algorithm for Ray
+ * Tracing", Eurographics, 1987.
+ *
+ * @param position ray origin
+ * @param direction ray direction, normalized
+ * @param ambiguous output, true if the ray grazes an edge, starts on a triangle or
+ * crosses one on a cell border, so that the count can't be trusted
+ * @return number of crossed triangles
+ */
+int StockSimulator::countCrossings(const Point3f& position, const Vector3f& direction, bool& ambiguous) const
+{
+	ambiguous = false;
+	double origins[3] = {position.x, position.y, position.z};
+	double directions[3] = {direction.x, direction.y, direction.z};
+	double lows[3] = {origin.x, origin.y, origin.z};
+
+	//part of the ray inside the grid
+	double enter = 0;
+	double exit = INFINITY;
+	for(int axis=0;axis<3;axis++)
+	{
+		double high = lows[axis]+dims[axis]*cellSize;
+		if(directions[axis]==0)
+		{
+			if(origins[axis]<lows[axis] || origins[axis]>high)
+			{
+				return 0;
+			}
+			continue;
+		}
+		double near = (lows[axis]-origins[axis])/directions[axis];
+		double far = (high-origins[axis])/directions[axis];
+		if(near>far)
+		{
+			std::swap(near, far);
+		}
+		enter = std::max(enter, near);
+		exit = std::min(exit, far);
+	}
+	if(enter>exit)
+	{
+		return 0;
+	}
+
+	int cell[3], steps[3];
+	double next[3], deltas[3];
+	for(int axis=0;axis<3;axis++)
+	{
+		double entry = origins[axis]+directions[axis]*enter;
+		cell[axis] = std::max(0, std::min(dims[axis]-1, (int)std::floor((entry-lows[axis])/cellSize)));
+		if(directions[axis]==0)
+		{
+			steps[axis] = 0;
+			next[axis] = INFINITY;
+			deltas[axis] = INFINITY;
+			continue;
+		}
+		steps[axis] = directions[axis]>0 ? 1 : -1;
+		double border = lows[axis]+(cell[axis]+(directions[axis]>0 ? 1 : 0))*cellSize;
+		next[axis] = (border-origins[axis])/directions[axis];
+		deltas[axis] = cellSize/std::abs(directions[axis]);
+	}
+
+	Vector3f ray = direction;
+	double tolerance = RAY_TOL*cellSize;
+	int crossings = 0;
+	double start = enter;
+	while(true)
+	{
+		int axis = next[0]<next[1] ? (next[0]<next[2] ? 0 : 2) : (next[1]<next[2] ? 1 : 2);
+		double end = std::min(next[axis], exit);
+		for(int triangle : cells[(cell[2]*dims[1]+cell[1])*dims[0]+cell[0]])
+		{
+			//Moller-Trumbore, as Solid::getHitDistance, keeping the barycentric coordinates
+			const Point3f& p1 = vertices[triangles[3*triangle]];
+			const Point3f& p2 = vertices[triangles[3*triangle+1]];
+			const Point3f& p3 = vertices[triangles[3*triangle+2]];
+			Vector3f edge1 = {p2.x-p1.x, p2.y-p1.y, p2.z-p1.z};
+			Vector3f edge2 = {p3.x-p1.x, p3.y-p1.y, p3.z-p1.z};
+			Vector3f normalRay;
+			normalRay.cross(ray, edge2);
+			double determinant = edge1.dot(normalRay);
+			if(determinant==0)
+			{
+				continue;
+			}
+			Vector3f offset = {position.x-p1.x, position.y-p1.y, position.z-p1.z};
+			double u = offset.dot(normalRay)/determinant;
+			if(u<-RAY_TOL || u>1+RAY_TOL)
+			{
+				continue;
+			}
+			Vector3f normalOffset;
+			normalOffset.cross(offset, edge1);
+			double v = ray.dot(normalOffset)/determinant;
+			if(v<-RAY_TOL || u+v>1+RAY_TOL)
+			{
+				continue;
+			}
+			double distance = edge2.dot(normalOffset)/determinant;
+			if(distance<-tolerance || distance>exit+tolerance)
+			{
+				continue;
+			}
+			if(std::abs(distance)<=tolerance || u<RAY_TOL || v<RAY_TOL || u+v>1-RAY_TOL ||
+				std::abs(distance-start)<=tolerance || std::abs(distance-end)<=tolerance)
+			{
+				ambiguous = true;
+				return crossings;
+			}
+			if(distance>=start && distance<end)
+			{
+				crossings++;
+			}
+		}
+		if(next[axis]>=exit)
+		{
+			break;
+		}
+		cell[axis] += steps[axis];
+		if(cell[axis]<0 || cell[axis]>=dims[axis])
+		{
+			break;
+		}
+		start = next[axis];
+		next[axis] += deltas[axis];
+	}
+	return crossings;
+}
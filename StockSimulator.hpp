@@ -0,0 +1,93 @@
+#ifndef __STOCK_SIMULATOR__
+#define __STOCK_SIMULATOR__
+
+#include<vector>
+#include"Point3f.hpp"
+#include"Bound.hpp"
+#include"Solid.hpp"
+
+/**
+ * Material removal of a tool following a path through a stock, as in a CNC
+ * simulation: the tool is substracted from the stock at each of its placements.
+ *
+ * <br><br>The stock is kept as triangles over a uniform grid. Each subtraction
+ * gathers through the grid the stock triangles overlapping the tool bound, and only
+ * those and the tool are split and classified (as by a BooleanModeller with
+ * BATCHED_SPLIT and WINDING_NUMBER). The rest of the stock isn't touched, so a step
+ * costs about the same on a large stock as on a small one. The tool faces are
+ * classified against the whole stock by the parity of the stock triangles a ray
+ * crosses, walking the grid cells along it.
+ *
+ * <br><br>Removed triangles leave holes in the arrays, which are compacted, and the
+ * grid sized again, once they are as many as the remaining ones or once the stock has
+ * grown finer than the grid was sized for.
+ *
+ * @author akatsia-games on github.com
+ */
+class StockSimulator
+{
+public:
+	StockSimulator(const Solid& stock);
+
+	void subtract(const Solid& tool);
+
+	Solid getStock() const;
+
+	int getNumTriangles() const;
+
+	int getNumNearFaces() const;
+
+private:
+	void rebuildIndex();
+
+	void addTriangle(int v1, int v2, int v3);
+
+	void removeTriangle(int triangle);
+
+	void getCellRange(const Bound& bound, int min[3], int max[3]) const;
+
+	bool isInside(const Point3f& point) const;
+
+	int countCrossings(const Point3f& origin, const Vector3f& direction, bool& ambiguous) const;
+
+	/** stock vertices, some of them not used after removals */
+	std::vector<Point3f> vertices;
+	/** stock vertex colors */
+	std::vector<Colour3f> colors;
+	/** stock triangles, three vertices each (-1 for removed triangles) */
+	std::vector<int> triangles;
+	/** number of removed triangles still on the array */
+	int numRemoved = 0;
+	/** number of triangles when the grid was sized */
+	int numIndexed = 0;
+	/** bound of the stock, covered by the grid */
+	Bound bound;
+	/** minimum corner of the grid */
+	Point3f origin;
+	/** side of the grid cells */
+	double cellSize = 1;
+	/** number of cells along each axis */
+	int dims[3] = {1, 1, 1};
+	/** triangles overlapping each cell, x first */
+	std::vector<std::vector<int>> cells;
+	/** step on which each triangle was last gathered, to gather it once */
+	std::vector<int> gathered;
+	/** number of subtractions done */
+	int numSteps = 0;
+	/** number of stock triangles split and classified by the last subtraction */
+	int numNearFaces = 0;
+
+	/** most cells along an axis, so that a large triangle covers a limited number of cells */
+	constexpr static const int MAX_DIMENSION = 128;
+	/** cells per triangle the grid is sized for */
+	static const int CELLS_PER_TRIANGLE = 2;
+	/** growth of the triangle count, since the grid was sized, after which it is sized again */
+	static const int REGRID_GROWTH = 4;
+	/** distance, relative to the longest edge, of the points sampled around a face (as in Face) */
+	constexpr static const double SAMPLE_OFFSET = 1e-6;
+	/** least distance of the points sampled around a face */
+	constexpr static const double MIN_SAMPLE_OFFSET = 1e-8;
+	/** barycentric distance to an edge under which a ray crossing is ambiguous, and another ray is cast */
+	constexpr static const double RAY_TOL = 1e-9;
+};
+#endif //__STOCK_SIMULATOR__
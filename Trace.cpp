@@ -0,0 +1,187 @@
+#include "Trace.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * Timeline tracing in the Chrome trace event format.
+ * 
+ * @author akatsia-games on github.com
+ */
+
+std::atomic<bool> Trace::recording(false);
+
+namespace
+{
+	/** a closed span */
+	struct Event
+	{
+		const char* name;
+		int64_t begin;
+		int64_t end;
+	};
+
+	/** spans recorded by one thread at a time */
+	struct Buffer
+	{
+		/** thread id written to the trace */
+		int thread;
+		/** true while a thread owns the buffer */
+		bool used;
+		std::vector<Event> events;
+	};
+
+	/** buffers of all the threads, kept for the lifetime of the process and reused */
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector<std::unique_ptr<Buffer>> buffers;
+		std::string path;
+		int64_t origin = 0;
+	};
+
+	Registry& getRegistry()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	/** buffer owned by the current thread, handed back when the thread ends */
+	struct ThreadBuffer
+	{
+		Buffer* buffer = nullptr;
+
+		~ThreadBuffer()
+		{
+			if(buffer!=nullptr)
+			{
+				Registry& registry = getRegistry();
+				std::lock_guard<std::mutex> lock(registry.mutex);
+				buffer->used = false;
+			}
+		}
+
+		Buffer& get()
+		{
+			if(buffer==nullptr)
+			{
+				Registry& registry = getRegistry();
+				std::lock_guard<std::mutex> lock(registry.mutex);
+				for(std::unique_ptr<Buffer>& candidate : registry.buffers)
+				{
+					if(!candidate->used)
+					{
+						buffer = candidate.get();
+						break;
+					}
+				}
+				if(buffer==nullptr)
+				{
+					registry.buffers.emplace_back(new Buffer{(int)registry.buffers.size()+1, false, {}});
+					buffer = registry.buffers.back().get();
+				}
+				buffer->used = true;
+			}
+			return *buffer;
+		}
+	};
+
+	thread_local ThreadBuffer threadBuffer;
+}
+
+/**
+ * Starts recording spans
+ * 
+ * @param path file the trace will be written to by stop()
+ * @return false if tracing isn't compiled in or a trace is already being recorded
+ */
+bool Trace::start(const std::string& path)
+{
+#ifdef UNBBOOLEAN_TRACE
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	if(isRecording())
+	{
+		return false;
+	}
+	for(std::unique_ptr<Buffer>& buffer : registry.buffers)
+	{
+		buffer->events.clear();
+	}
+	registry.path = path;
+	registry.origin = getTime();
+	recording.store(true, std::memory_order_relaxed);
+	return true;
+#else
+	(void)path;
+	return false;
+#endif
+}
+
+/**
+ * Stops recording spans and writes them to the file given to start()
+ * 
+ * @return false if no trace was being recorded or the file couldn't be written
+ */
+bool Trace::stop()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	if(!isRecording())
+	{
+		return false;
+	}
+	recording.store(false, std::memory_order_relaxed);
+	
+	std::ofstream file(registry.path, std::ios::binary);
+	file<<"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+	char line[256];
+	for(std::unique_ptr<Buffer>& buffer : registry.buffers)
+	{
+		if(buffer->events.empty())
+		{
+			continue;
+		}
+		snprintf(line, sizeof(line), "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}", first ? "" : ",", buffer->thread, buffer->thread);
+		file<<line;
+		first = false;
+		for(const Event& event : buffer->events)
+		{
+			//names are literals from the code, written without escaping
+			snprintf(line, sizeof(line), ",\n{\"name\":\"%.160s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", event.name, buffer->thread, (event.begin-registry.origin)/1e3, (event.end-event.begin)/1e3);
+			file<<line;
+		}
+		buffer->events.clear();
+	}
+	file<<"\n]}\n";
+	return file.good();
+}
+
+/**
+ * Gets a monotonic time stamp
+ * 
+ * @return time in nanoseconds from an arbitrary origin
+ */
+int64_t Trace::getTime()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Appends a closed span to the buffer of the current thread
+ * 
+ * @param name span name
+ * @param begin opening time in nanoseconds
+ * @param end closing time in nanoseconds
+ */
+void Trace::record(const char* name, int64_t begin, int64_t end)
+{
+	if(isRecording())
+	{
+		threadBuffer.get().events.push_back({name, begin, end});
+	}
+}
@@ -0,0 +1,90 @@
+#ifndef __TRACE__
+#define __TRACE__
+
+#include<atomic>
+#include<cstdint>
+#include<string>
+
+/**
+ * Timeline tracing in the Chrome trace event format, readable by chrome://tracing
+ * and Perfetto.
+ *
+ * <br><br>Spans are opened with TRACE_SCOPE("name") and closed at the end of the
+ * enclosing scope. The macro expands to nothing unless the library is built with
+ * the UNBBOOLEAN_TRACE option, so untraced builds pay nothing. In traced builds,
+ * spans are only recorded between start() and stop(); each thread appends them to
+ * its own buffer, so recording takes no lock.
+ *
+ * <br><br>stop() writes the file and must be called when no traced work is running.
+ *
+ * @author akatsia-games on github.com
+ */
+class Trace
+{
+public:
+	static bool start(const std::string& path);
+
+	static bool stop();
+
+	/**
+	 * Checks if spans are being recorded
+	 *
+	 * @return true between start() and stop()
+	 */
+	static bool isRecording()
+	{
+		return recording.load(std::memory_order_relaxed);
+	}
+
+	/** Records a span from its construction to its destruction */
+	class Scope
+	{
+	public:
+		/**
+		 * Opens a span
+		 *
+		 * @param spanName span name, must outlive the trace (usually a literal)
+		 */
+		Scope(const char* spanName)
+			:name(isRecording() ? spanName : nullptr)
+			,begin(name==nullptr ? 0 : getTime())
+		{
+		}
+
+		/** Closes the span */
+		~Scope()
+		{
+			if(name!=nullptr)
+			{
+				record(name, begin, getTime());
+			}
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		/** span name, null if the span isn't recorded */
+		const char* name;
+		/** opening time in nanoseconds */
+		int64_t begin;
+	};
+
+private:
+	static int64_t getTime();
+
+	static void record(const char* name, int64_t begin, int64_t end);
+
+	/** true between start() and stop() */
+	static std::atomic<bool> recording;
+};
+
+#ifdef UNBBOOLEAN_TRACE
+#define TRACE_CONCATENATE(first, second) first##second
+#define TRACE_VARIABLE(line) TRACE_CONCATENATE(traceScope, line)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_VARIABLE(__LINE__)(name)
+#else
+#define TRACE_SCOPE(name)
+#endif
+
+#endif //__TRACE__
@@ -0,0 +1,161 @@
+#include "TriangleTree.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+
+/**
+ * Bounding volume hierarchy over a set of triangles.
+ * 
+ * @author akatsia-games on github.com
+ */
+
+//---------------------------------CONSTRUCTORS---------------------------------//
+
+/**
+ * Builds the hierarchy, splitting each node at the median centroid of its widest axis
+ * 
+ * @param corners triangle corners, three per triangle
+ */
+TriangleTree::TriangleTree(const std::vector<Point3f>& corners)
+	:corners(corners)
+{
+	TRACE_SCOPE("TriangleTree::TriangleTree");
+	int numTriangles = getNumTriangles();
+	std::vector<Point3f> centroids(numTriangles);
+	order.resize(numTriangles);
+	for(int i=0;i<numTriangles;i++)
+	{
+		const Point3f& p1 = corners[3*i];
+		const Point3f& p2 = corners[3*i+1];
+		const Point3f& p3 = corners[3*i+2];
+		centroids[i] = {(p1.x+p2.x+p3.x)/3.0, (p1.y+p2.y+p3.y)/3.0, (p1.z+p2.z+p3.z)/3.0};
+		order[i] = i;
+	}
+
+	if(numTriangles>0)
+	{
+		nodes.reserve(2*(numTriangles/LEAF_SIZE+1));
+		build(0, numTriangles, centroids);
+	}
+}
+
+//-------------------------------------GETS-------------------------------------//
+
+/**
+ * Gets the number of triangles
+ * 
+ * @return number of triangles
+ */
+int TriangleTree::getNumTriangles() const
+{
+	return corners.size()/3;
+}
+
+/**
+ * Gets the number of nodes
+ * 
+ * @return number of nodes
+ */
+int TriangleTree::getNumNodes() const
+{
+	return nodes.size();
+}
+
+/**
+ * Gets a node
+ * 
+ * @param index node position
+ * @return the node
+ */
+const TriangleTree::Node& TriangleTree::getNode(int index) const
+{
+	return nodes[index];
+}
+
+/**
+ * Gets the triangle stored at a position of the tree order
+ * 
+ * @param position position between the begin and end of a node
+ * @return index of the triangle on the corners array given to the constructor
+ */
+int TriangleTree::getTriangle(int position) const
+{
+	return order[position];
+}
+
+/**
+ * Gets a triangle corner
+ * 
+ * @param triangle triangle index
+ * @param corner corner number (0, 1 or 2)
+ * @return corner position
+ */
+const Point3f& TriangleTree::getCorner(int triangle, int corner) const
+{
+	return corners[3*triangle+corner];
+}
+
+/**
+ * Gets the bytes allocated by the tree
+ * 
+ * @return allocated bytes
+ */
+size_t TriangleTree::getMemoryUsage() const
+{
+	return corners.capacity()*sizeof(Point3f) + order.capacity()*sizeof(int) + nodes.capacity()*sizeof(Node);
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/**
+ * Builds the node covering a range of the triangle order
+ * 
+ * @param begin first order position
+ * @param end one past the last order position
+ * @param centroids triangle centroids
+ * @return position of the node created
+ */
+int TriangleTree::build(int begin, int end, const std::vector<Point3f>& centroids)
+{
+	int index = nodes.size();
+	nodes.emplace_back();
+	
+	Bound bound;
+	Bound centroidBound;
+	for(int i=begin;i<end;i++)
+	{
+		int triangle = order[i];
+		bound = Bound(bound, Bound(corners[3*triangle], corners[3*triangle+1], corners[3*triangle+2]));
+		centroidBound = Bound(centroidBound, Bound(centroids[triangle], centroids[triangle], centroids[triangle]));
+	}
+	nodes[index].bound = bound;
+	nodes[index].begin = begin;
+	nodes[index].end = end;
+	nodes[index].left = -1;
+	nodes[index].right = -1;
+	
+	if(end-begin<=LEAF_SIZE)
+	{
+		return index;
+	}
+	
+	//split on the widest axis of the centroids
+	Point3f extent = {centroidBound.getMax().x-centroidBound.getMin().x, centroidBound.getMax().y-centroidBound.getMin().y, centroidBound.getMax().z-centroidBound.getMin().z};
+	int axis = (extent.x>=extent.y && extent.x>=extent.z) ? 0 : (extent.y>=extent.z ? 1 : 2);
+	int middle = (begin+end)/2;
+	std::nth_element(order.begin()+begin, order.begin()+middle, order.begin()+end,
+		[&centroids, axis](int a, int b)
+		{
+			switch(axis)
+			{
+				case 0: return centroids[a].x<centroids[b].x;
+				case 1: return centroids[a].y<centroids[b].y;
+				default: return centroids[a].z<centroids[b].z;
+			}
+		});
+	
+	int left = build(begin, middle, centroids);
+	int right = build(middle, end, centroids);
+	nodes[index].left = left;
+	nodes[index].right = right;
+	return index;
+}
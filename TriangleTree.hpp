@@ -0,0 +1,63 @@
+#ifndef __TRIANGLE_TREE__
+#define __TRIANGLE_TREE__
+
+#include<vector>
+#include"Point3f.hpp"
+#include"Bound.hpp"
+
+/**
+ * Bounding volume hierarchy over a set of triangles.
+ * 
+ * <br><br>The triangles are given as a flat array of corners (three per triangle). 
+ * Each node stores the bound of the triangles below it and the range they occupy
+ * in the triangle order, so leaves can be visited without extra indirections.
+ * 
+ * @author akatsia-games on github.com
+ */
+class TriangleTree
+{
+public:
+	/** node of the hierarchy */
+	struct Node
+	{
+		/** bound of all the triangles below the node */
+		Bound bound;
+		/** position of the children on the nodes array (-1 for leaves) */
+		int left;
+		int right;
+		/** range of triangle order positions covered by the node */
+		int begin;
+		int end;
+	};
+
+	TriangleTree(const std::vector<Point3f>& corners);
+
+	int getNumTriangles() const;
+
+	int getNumNodes() const;
+
+	const Node& getNode(int index) const;
+
+	int getTriangle(int position) const;
+
+	const Point3f& getCorner(int triangle, int corner) const;
+
+	size_t getMemoryUsage() const;
+
+	/** position of the root node (there are no nodes for an empty tree) */
+	static const int ROOT = 0;
+
+private:
+	int build(int begin, int end, const std::vector<Point3f>& centroids);
+
+	/** triangle corners, three per triangle */
+	std::vector<Point3f> corners;
+	/** triangle indices sorted so that every node covers a contiguous range */
+	std::vector<int> order;
+	/** tree nodes, root first */
+	std::vector<Node> nodes;
+
+	/** maximum number of triangles on a leaf */
+	static const int LEAF_SIZE = 8;
+};
+#endif //__TRIANGLE_TREE__
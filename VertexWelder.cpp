@@ -0,0 +1,134 @@
+#include "VertexWelder.hpp"
+#include "Face.hpp"
+#include <cmath>
+#include <utility>
+
+/**
+ * Welds the vertices of the faces composing a solid.
+ *
+ * @author akatsia-games on github.com
+ */
+
+//---------------------------------CONSTRUCTORS---------------------------------//
+
+/**
+ * Constructs a welder appending the new vertices to the given arrays. The vertices
+ * already on them are only welded to once given to addVertex.
+ *
+ * @param vertices vertex positions, appended to
+ * @param colors vertex colors, appended to with the positions
+ */
+VertexWelder::VertexWelder(std::vector<Point3f>& vertices, std::vector<Colour3f>& colors)
+	:vertices(vertices)
+	,colors(colors)
+{
+}
+
+//-------------------------------------SETS-------------------------------------//
+
+/**
+ * Adds a vertex of the arrays to the grid, so that the next vertices may be welded to it
+ *
+ * @param vertex index of the vertex on the arrays
+ */
+void VertexWelder::addVertex(int vertex)
+{
+	grid[getCell(vertices[vertex])].push_back(vertex);
+}
+
+/**
+ * Welds a vertex to the first equal one on the grid, or appends it to the arrays
+ *
+ * @param position vertex position
+ * @param color vertex color
+ * @return index of the welded vertex on the arrays
+ */
+int VertexWelder::weld(const Point3f& position, Colour3f color)
+{
+	std::array<long long,3> cell = getCell(position);
+	int found = -1;
+	for(int dx=-1;dx<=1;dx++)
+	{
+		for(int dy=-1;dy<=1;dy++)
+		{
+			for(int dz=-1;dz<=1;dz++)
+			{
+				auto it = grid.find({cell[0]+dx, cell[1]+dy, cell[2]+dz});
+				if(it==grid.end())
+				{
+					continue;
+				}
+				for(int other : it->second)
+				{
+					if((found<0 || other<found) && std::abs(vertices[other].x-position.x)<TOL && std::abs(vertices[other].y-position.y)<TOL &&
+						std::abs(vertices[other].z-position.z)<TOL && colors[other].equals(color))
+					{
+						found = other;
+					}
+				}
+			}
+		}
+	}
+	if(found<0)
+	{
+		found = vertices.size();
+		vertices.push_back(position);
+		colors.push_back(color);
+		grid[cell].push_back(found);
+	}
+	return found;
+}
+
+/**
+ * Welds the corners of a face, in the order given by its orientation on the solid:
+ * inverted faces swap their first two vertices, as Face::invert
+ *
+ * @param face face of an object
+ * @param orientation 1 to keep the face as it is, -1 to invert it
+ * @param weldedOf welded vertex of each object vertex, -1 if not welded yet, updated
+ * @param welded output, welded vertices of the face corners
+ */
+void VertexWelder::weldFace(const Face& face, int orientation, std::vector<int>& weldedOf, int welded[3])
+{
+	const Vertex* corners[3] = {&face.v1(), &face.v2(), &face.v3()};
+	int objectVertices[3] = {face.v[0], face.v[1], face.v[2]};
+	if(orientation<0)
+	{
+		std::swap(corners[0], corners[1]);
+		std::swap(objectVertices[0], objectVertices[1]);
+	}
+	for(int corner=0;corner<3;corner++)
+	{
+		int& weldedIndex = weldedOf[objectVertices[corner]];
+		if(weldedIndex<0)
+		{
+			weldedIndex = weld(corners[corner]->getPosition(), corners[corner]->getColor());
+		}
+		welded[corner] = weldedIndex;
+	}
+}
+
+//-------------------------------------GETS-------------------------------------//
+
+/**
+ * Gets the number of cells of the grid holding some vertex
+ *
+ * @return number of cells
+ */
+int VertexWelder::getNumCells() const
+{
+	return grid.size();
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/**
+ * Gets the grid cell of a position
+ *
+ * @param position vertex position
+ * @return cell coordinates
+ */
+std::array<long long,3> VertexWelder::getCell(const Point3f& position)
+{
+	return {(long long)std::floor(position.x/TOL), (long long)std::floor(position.y/TOL), (long long)std::floor(position.z/TOL)};
+}
@@ -0,0 +1,47 @@
+#ifndef __VERTEX_WELDER__
+#define __VERTEX_WELDER__
+
+#include<array>
+#include<map>
+#include<vector>
+#include"Point3f.hpp"
+
+class Face;
+
+/**
+ * Welds the vertices of the faces composing a solid, so that the faces share them.
+ *
+ * <br><br>A vertex is welded to the first one on the arrays with the same color and
+ * coordinates within TOL (as Vertex::equals), found through a grid of cells as wide as
+ * TOL; otherwise it is appended to the arrays. Vertices already on the arrays may be
+ * added to the grid, so that the faces are welded to them too.
+ *
+ * @author akatsia-games on github.com
+ */
+class VertexWelder
+{
+public:
+	VertexWelder(std::vector<Point3f>& vertices, std::vector<Colour3f>& colors);
+
+	void addVertex(int vertex);
+
+	int weld(const Point3f& position, Colour3f color);
+
+	void weldFace(const Face& face, int orientation, std::vector<int>& weldedOf, int welded[3]);
+
+	int getNumCells() const;
+
+	/** distance under which two coordinates are welded, the Vertex tolerance */
+	constexpr static const double TOL = 1e-5;
+
+private:
+	static std::array<long long,3> getCell(const Point3f& position);
+
+	/** vertices the faces are welded to */
+	std::vector<Point3f>& vertices;
+	/** colors of the vertices */
+	std::vector<Colour3f>& colors;
+	/** vertices in each cell of the grid */
+	std::map<std::array<long long,3>, std::vector<int>> grid;
+};
+#endif //__VERTEX_WELDER__
@@ -0,0 +1,277 @@
+#include "WindingNumber.hpp"
+#include "Object3D.hpp"
+#include "Solid.hpp"
+#include "Trace.hpp"
+
+/**
+ * Fast generalized winding number of a triangle mesh.
+ * 
+ * <br><br>See: 
+ * G. Barill, N. Dickson, R. Schmidt, D. I. W. Levin, A. Jacobson.  
+ * "Fast Winding Numbers for Soups and Clouds" 
+ * ACM Transactions on Graphics, 2018. 
+ * 
+ * @author akatsia-games on github.com
+ */
+
+//---------------------------------CONSTRUCTORS---------------------------------//
+
+/**
+ * Constructs the winding number of the faces of an object
+ * 
+ * @param object object whose faces define the mesh
+ */
+WindingNumber::WindingNumber(const Object3D& object)
+	:tree(getCorners(object))
+{
+	computeDipoles();
+}
+
+/**
+ * Constructs the winding number of a solid
+ * 
+ * @param solid solid whose triangles define the mesh
+ */
+WindingNumber::WindingNumber(const Solid& solid)
+	:tree(getCorners(solid))
+{
+	computeDipoles();
+}
+
+/**
+ * Constructs the winding number of a triangle soup
+ * 
+ * @param corners triangle corners, three per triangle
+ */
+WindingNumber::WindingNumber(const std::vector<Point3f>& corners)
+	:tree(corners)
+{
+	computeDipoles();
+}
+
+//-------------------------------------GETS-------------------------------------//
+
+/**
+ * Computes the winding number of a point
+ * 
+ * @param point point to be tested
+ * @return winding number (about 1 inside the mesh, about 0 outside)
+ */
+double WindingNumber::compute(const Point3f& point) const
+{
+	if(tree.getNumNodes()==0)
+	{
+		return 0;
+	}
+	
+	double sum = 0;
+	int stack[64];
+	int top = 0;
+	stack[top++] = TriangleTree::ROOT;
+	while(top>0)
+	{
+		int index = stack[--top];
+		const TriangleTree::Node& node = tree.getNode(index);
+		
+		Vector3f toCenter = {centers[index].x-point.x, centers[index].y-point.y, centers[index].z-point.z};
+		double distanceSqr = toCenter.dot(toCenter);
+		
+		//far away node: dipole approximation
+		if(distanceSqr>ACCURACY*ACCURACY*radii[index])
+		{
+			double distance = sqrt(distanceSqr);
+			sum += toCenter.dot(normals[index])/(distanceSqr*distance);
+		}
+		//near leaf: exact solid angles
+		else if(node.left<0)
+		{
+			for(int i=node.begin;i<node.end;i++)
+			{
+				int triangle = tree.getTriangle(i);
+				sum += solidAngle(point, tree.getCorner(triangle,0), tree.getCorner(triangle,1), tree.getCorner(triangle,2));
+			}
+		}
+		else
+		{
+			stack[top++] = node.left;
+			stack[top++] = node.right;
+		}
+	}
+	
+	return sum/(4.0*M_PI);
+}
+
+/**
+ * Checks if a point is inside the mesh
+ * 
+ * @param point point to be tested
+ * @return true if the winding number is above one half, false otherwise
+ */
+bool WindingNumber::isInside(const Point3f& point) const
+{
+	return compute(point)>0.5;
+}
+
+/**
+ * Gets the hierarchy over the mesh triangles
+ * 
+ * @return triangle hierarchy
+ */
+const TriangleTree& WindingNumber::getTree() const
+{
+	return tree;
+}
+
+/**
+ * Gets the bytes allocated by the hierarchy and the dipoles
+ * 
+ * @return allocated bytes
+ */
+size_t WindingNumber::getMemoryUsage() const
+{
+	return tree.getMemoryUsage() + centers.capacity()*sizeof(Point3f) + normals.capacity()*sizeof(Vector3f) + radii.capacity()*sizeof(double);
+}
+
+//-------------------------------------PRIVATES---------------------------------//
+
+/** Computes the dipole of every node, children before parents */
+void WindingNumber::computeDipoles()
+{
+	TRACE_SCOPE("WindingNumber::computeDipoles");
+	int numNodes = tree.getNumNodes();
+	centers.resize(numNodes);
+	normals.resize(numNodes);
+	radii.resize(numNodes);
+	
+	std::vector<double> areas(numNodes, 0);
+	
+	//nodes are stored in depth first order, so children always come after their parent
+	for(int index=numNodes-1;index>=0;index--)
+	{
+		const TriangleTree::Node& node = tree.getNode(index);
+		Vector3f center = {0,0,0};
+		Vector3f normal = {0,0,0};
+		double area = 0;
+		if(node.left<0)
+		{
+			for(int i=node.begin;i<node.end;i++)
+			{
+				int triangle = tree.getTriangle(i);
+				const Point3f& p1 = tree.getCorner(triangle,0);
+				const Point3f& p2 = tree.getCorner(triangle,1);
+				const Point3f& p3 = tree.getCorner(triangle,2);
+				Vector3f edge1 = {p2.x-p1.x, p2.y-p1.y, p2.z-p1.z};
+				Vector3f edge2 = {p3.x-p1.x, p3.y-p1.y, p3.z-p1.z};
+				Vector3f triangleNormal;
+				triangleNormal.cross(edge1, edge2);
+				triangleNormal *= 0.5;
+				double triangleArea = triangleNormal.length();
+				
+				normal += triangleNormal;
+				center += Vector3f({(p1.x+p2.x+p3.x)/3.0, (p1.y+p2.y+p3.y)/3.0, (p1.z+p2.z+p3.z)/3.0})*triangleArea;
+				area += triangleArea;
+			}
+		}
+		else
+		{
+			for(int child : {node.left, node.right})
+			{
+				normal += normals[child];
+				center += Vector3f(centers[child])*areas[child];
+				area += areas[child];
+			}
+		}
+		
+		//degenerated clusters fall back to the middle of their bound
+		if(area>0)
+		{
+			center *= 1.0/area;
+		}
+		else
+		{
+			Point3f min = node.bound.getMin();
+			Point3f max = node.bound.getMax();
+			center = {(min.x+max.x)/2.0, (min.y+max.y)/2.0, (min.z+max.z)/2.0};
+		}
+		
+		//farthest bound corner from the center
+		Point3f min = node.bound.getMin();
+		Point3f max = node.bound.getMax();
+		double dx = std::max(std::abs(center.x-min.x), std::abs(center.x-max.x));
+		double dy = std::max(std::abs(center.y-min.y), std::abs(center.y-max.y));
+		double dz = std::max(std::abs(center.z-min.z), std::abs(center.z-max.z));
+		
+		centers[index] = center;
+		normals[index] = normal;
+		areas[index] = area;
+		radii[index] = dx*dx + dy*dy + dz*dz;
+	}
+}
+
+/**
+ * Computes the signed solid angle of a triangle seen from a point
+ * 
+ * <br><br>See: A. Van Oosterom and J. Strackee. "The Solid Angle of a Plane Triangle"
+ * IEEE Transactions on Biomedical Engineering, 1983.
+ * 
+ * @param point point the triangle is seen from
+ * @param p1 first triangle corner
+ * @param p2 second triangle corner
+ * @param p3 third triangle corner
+ * @return signed solid angle, positive when the point is behind the triangle
+ */
+double WindingNumber::solidAngle(const Point3f& point, const Point3f& p1, const Point3f& p2, const Point3f& p3)
+{
+	Vector3f a = {p1.x-point.x, p1.y-point.y, p1.z-point.z};
+	Vector3f b = {p2.x-point.x, p2.y-point.y, p2.z-point.z};
+	Vector3f c = {p3.x-point.x, p3.y-point.y, p3.z-point.z};
+	double la = a.length();
+	double lb = b.length();
+	double lc = c.length();
+	
+	Vector3f bc;
+	bc.cross(b, c);
+	double numerator = a.dot(bc);
+	double denominator = la*lb*lc + a.dot(b)*lc + b.dot(c)*la + c.dot(a)*lb;
+	
+	return 2.0*atan2(numerator, denominator);
+}
+
+/**
+ * Gets the corners of the faces of an object
+ * 
+ * @param object object whose faces are read
+ * @return triangle corners, three per face
+ */
+std::vector<Point3f> WindingNumber::getCorners(const Object3D& object)
+{
+	std::vector<Point3f> corners;
+	corners.reserve(3*object.getNumFaces());
+	for(int i=0;i<object.getNumFaces();i++)
+	{
+		const Face& face = object.getFace(i);
+		corners.push_back(face.v1().getPosition());
+		corners.push_back(face.v2().getPosition());
+		corners.push_back(face.v3().getPosition());
+	}
+	return corners;
+}
+
+/**
+ * Gets the corners of the triangles of a solid
+ * 
+ * @param solid solid whose triangles are read
+ * @return triangle corners, three per triangle
+ */
+std::vector<Point3f> WindingNumber::getCorners(const Solid& solid)
+{
+	const std::vector<Point3f>& vertices = solid.getVertices();
+	const std::vector<int>& indices = solid.getIndices();
+	std::vector<Point3f> corners;
+	corners.reserve(indices.size());
+	for(int index : indices)
+	{
+		corners.push_back(vertices[index]);
+	}
+	return corners;
+}
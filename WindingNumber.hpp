@@ -0,0 +1,65 @@
+#ifndef __WINDING_NUMBER__
+#define __WINDING_NUMBER__
+
+#include<vector>
+#include"Point3f.hpp"
+#include"TriangleTree.hpp"
+
+class Object3D;
+class Solid;
+
+/**
+ * Fast generalized winding number of a triangle mesh.
+ * 
+ * <br><br>The winding number of a point is the sum of the signed solid angles of the 
+ * mesh triangles as seen from it, divided by 4*pi. It is close to 1 inside a closed 
+ * solid and close to 0 outside, and degrades gracefully on meshes with cracks. Far 
+ * away clusters of triangles are replaced by a dipole placed at their area weighted
+ * centroid, so a query costs O(log n).
+ * 
+ * <br><br>See: 
+ * G. Barill, N. Dickson, R. Schmidt, D. I. W. Levin, A. Jacobson.  
+ * "Fast Winding Numbers for Soups and Clouds" 
+ * ACM Transactions on Graphics, 2018. 
+ * 
+ * @author akatsia-games on github.com
+ */
+class WindingNumber
+{
+public:
+	WindingNumber(const Object3D& object);
+
+	WindingNumber(const Solid& solid);
+
+	WindingNumber(const std::vector<Point3f>& corners);
+
+	double compute(const Point3f& point) const;
+
+	bool isInside(const Point3f& point) const;
+
+	const TriangleTree& getTree() const;
+
+	size_t getMemoryUsage() const;
+
+private:
+	void computeDipoles();
+
+	static double solidAngle(const Point3f& point, const Point3f& p1, const Point3f& p2, const Point3f& p3);
+
+	static std::vector<Point3f> getCorners(const Object3D& object);
+
+	static std::vector<Point3f> getCorners(const Solid& solid);
+
+	/** hierarchy over the mesh triangles */
+	TriangleTree tree;
+	/** area weighted centroid of each node */
+	std::vector<Point3f> centers;
+	/** sum of the area weighted normals of each node */
+	std::vector<Vector3f> normals;
+	/** squared radius of the ball around each center enclosing the node bound */
+	std::vector<double> radii;
+
+	/** distance, in node radii, from which a node is replaced by its dipole */
+	constexpr static const double ACCURACY = 2.0;
+};
+#endif //__WINDING_NUMBER__
@@ -0,0 +1,657 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include "BooleanModeller.hpp"
+#include "CoordinateFile.hpp"
+#include "ObjFile.hpp"
+#include "PlyFile.hpp"
+#include "Solid.hpp"
+#include "SolidView.hpp"
+#include "StlFile.hpp"
+
+/**
+ * End to end boolean benchmark: loads pairs of solid files, runs union, intersection and
+ * difference through BooleanModeller and records wall time, peak resident memory, output
+ * face count and output volume of each operation as JSON.
+ *
+ * <br><br>When a baseline (a JSON file written by a previous run) is given, every result is
+ * compared to it: slower operations are flagged as regressions, and output volumes that
+ * differ are flagged as mismatches, so a speedup can't silently change the geometry. The
+ * exit status is 2 if anything was flagged.
+ *
+ * <br><br>Usage: BooleanBenchmark [options] solid1 solid2 [solid1 solid2 ...]
+ * <br>--output FILE            write the results to FILE instead of the standard output
+ * <br>--baseline FILE          compare the results to FILE
+ * <br>--repetitions N          runs per operation, the fastest is kept (default 3)
+ * <br>--time-tolerance X       allowed relative slowdown (default 0.10)
+ * <br>--volume-tolerance X     allowed relative volume difference (default 1e-6)
+ * <br>--winding-number         classify faces by winding number instead of ray tracing
+ *
+ * <br><br>Files are read by extension (.stl, .obj, .ply); other files are read as binary
+ * meshes if they start with the binary mesh magic, or as coordinate files otherwise.
+ *
+ * @author akatsia-games on github.com
+ */
+
+static const int UNION = 0;
+static const int INTERSECTION = 1;
+static const int DIFFERENCE = 2;
+static const int NUM_OPERATIONS = 3;
+
+static const char* OPERATION_NAMES[NUM_OPERATIONS] = {"union", "intersection", "difference"};
+
+/** measurements of one operation */
+struct Result
+{
+	std::string name;
+	std::string operation;
+	double time;
+	double peakRss;
+	double faces;
+	double volume;
+};
+
+//-------------------------------------INPUT-------------------------------------//
+
+/**
+ * Checks the extension of a path, ignoring case
+ *
+ * @param path file path
+ * @param extension extension including the dot
+ * @return true if the path ends with the extension
+ */
+static bool hasExtension(const std::string& path, const char* extension)
+{
+	size_t length = strlen(extension);
+	if(path.size()<length)
+	{
+		return false;
+	}
+	for(size_t i=0;i<length;i++)
+	{
+		if(tolower(path[path.size()-length+i])!=extension[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Loads a solid of any supported format
+ *
+ * @param path file path
+ * @param solid output solid
+ * @return false if the file couldn't be read
+ */
+static bool loadSolid(const std::string& path, Solid& solid)
+{
+	Colour3f color = {0.5, 0.5, 0.5};
+	if(hasExtension(path, ".stl"))
+	{
+		return StlFile::load(path, solid, color);
+	}
+	if(hasExtension(path, ".obj"))
+	{
+		return ObjFile::load(path, solid, color);
+	}
+	if(hasExtension(path, ".ply"))
+	{
+		return PlyFile::load(path, solid, color);
+	}
+
+	SolidView view(path);
+	if(view.isValid())
+	{
+		solid = Solid(view, color);
+		return true;
+	}
+	return CoordinateFile::load(path, solid, color);
+}
+
+/**
+ * Gets the file name without its directories
+ *
+ * @param path file path
+ * @return file name
+ */
+static std::string getFileName(const std::string& path)
+{
+	size_t slash = path.find_last_of("/\\");
+	return slash==std::string::npos ? path : path.substr(slash+1);
+}
+
+//-------------------------------------MEMORY------------------------------------//
+
+/**
+ * Resets the peak resident memory of the process, where the system allows it
+ *
+ * @return true if the peak was reset
+ */
+static bool resetPeakRss()
+{
+	std::ofstream clearRefs("/proc/self/clear_refs");
+	clearRefs<<"5";
+	clearRefs.flush();
+	return clearRefs.good();
+}
+
+/**
+ * Gets the peak resident memory of the process
+ *
+ * @return peak resident memory in bytes
+ */
+static double getPeakRss()
+{
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while(std::getline(status, line))
+	{
+		if(line.compare(0, 6, "VmHWM:")==0)
+		{
+			return atof(line.c_str()+6)*1024;
+		}
+	}
+
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss*1024.0;
+}
+
+//--------------------------------------JSON-------------------------------------//
+
+/**
+ * Writes a string as a JSON string literal
+ *
+ * @param output stream to write to
+ * @param text string to write
+ */
+static void writeJsonString(std::ostream& output, const std::string& text)
+{
+	output<<'"';
+	for(char c : text)
+	{
+		if(c=='"' || c=='\\')
+		{
+			output<<'\\'<<c;
+		}
+		else if((unsigned char)c<0x20)
+		{
+			char escaped[8];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+			output<<escaped;
+		}
+		else
+		{
+			output<<c;
+		}
+	}
+	output<<'"';
+}
+
+/**
+ * Writes the results as JSON
+ *
+ * @param output stream to write to
+ * @param results results to write
+ */
+static void writeResults(std::ostream& output, const std::vector<Result>& results)
+{
+	output.precision(17);
+	output<<"{\n\t\"results\": [";
+	for(size_t i=0;i<results.size();i++)
+	{
+		output<<(i==0 ? "\n" : ",\n")<<"\t\t{\"name\": ";
+		writeJsonString(output, results[i].name);
+		output<<", \"operation\": ";
+		writeJsonString(output, results[i].operation);
+		output<<", \"time\": "<<results[i].time;
+		output<<", \"peakRss\": "<<results[i].peakRss;
+		output<<", \"faces\": "<<results[i].faces;
+		output<<", \"volume\": "<<results[i].volume<<"}";
+	}
+	output<<"\n\t]\n}\n";
+}
+
+/**
+ * Minimal reader for the results files written by writeResults(). Any valid JSON is
+ * accepted; objects holding "name" and "operation" strings are collected as results
+ * and their known numeric members are read.
+ */
+class JsonReader
+{
+public:
+	JsonReader(const std::string& text)
+		:position(text.c_str())
+		,end(text.c_str()+text.size())
+	{
+	}
+
+	/**
+	 * Reads the whole document
+	 *
+	 * @param results output, results found in the document
+	 * @return false if the document is not valid JSON
+	 */
+	bool read(std::vector<Result>& results)
+	{
+		if(!readValue(results))
+		{
+			return false;
+		}
+		skipSpaces();
+		return position==end;
+	}
+
+private:
+	void skipSpaces()
+	{
+		while(position<end && isspace((unsigned char)*position))
+		{
+			position++;
+		}
+	}
+
+	bool readString(std::string& text)
+	{
+		skipSpaces();
+		if(position==end || *position!='"')
+		{
+			return false;
+		}
+		position++;
+		text.clear();
+		while(position<end && *position!='"')
+		{
+			if(*position=='\\')
+			{
+				position++;
+				if(position==end)
+				{
+					return false;
+				}
+				if(*position=='u')
+				{
+					if(end-position<5)
+					{
+						return false;
+					}
+					text += (char)strtol(std::string(position+1, 4).c_str(), nullptr, 16);
+					position += 5;
+					continue;
+				}
+				const char* escapes = "\"\\/bfnrt";
+				const char* values = "\"\\/\b\f\n\r\t";
+				const char* found = strchr(escapes, *position);
+				if(found==nullptr || *found=='\0')
+				{
+					return false;
+				}
+				text += values[found-escapes];
+			}
+			else
+			{
+				text += *position;
+			}
+			position++;
+		}
+		if(position==end)
+		{
+			return false;
+		}
+		position++;
+		return true;
+	}
+
+	bool readNumber(double& value)
+	{
+		skipSpaces();
+		char* numberEnd;
+		std::string number(position, std::min<size_t>(end-position, 64));
+		value = strtod(number.c_str(), &numberEnd);
+		if(numberEnd==number.c_str())
+		{
+			return false;
+		}
+		position += numberEnd-number.c_str();
+		return true;
+	}
+
+	bool readObject(std::vector<Result>& results)
+	{
+		position++;
+		std::map<std::string, std::string> strings;
+		std::map<std::string, double> numbers;
+		skipSpaces();
+		if(position<end && *position=='}')
+		{
+			position++;
+			return true;
+		}
+		while(true)
+		{
+			std::string key;
+			if(!readString(key))
+			{
+				return false;
+			}
+			skipSpaces();
+			if(position==end || *position!=':')
+			{
+				return false;
+			}
+			position++;
+			skipSpaces();
+			if(position<end && *position=='"')
+			{
+				if(!readString(strings[key]))
+				{
+					return false;
+				}
+			}
+			else if(position<end && (*position=='-' || isdigit((unsigned char)*position)))
+			{
+				if(!readNumber(numbers[key]))
+				{
+					return false;
+				}
+			}
+			else if(!readValue(results))
+			{
+				return false;
+			}
+			skipSpaces();
+			if(position<end && *position==',')
+			{
+				position++;
+				continue;
+			}
+			if(position<end && *position=='}')
+			{
+				position++;
+				break;
+			}
+			return false;
+		}
+
+		if(strings.count("name") && strings.count("operation"))
+		{
+			Result result = {strings["name"], strings["operation"], NAN, NAN, NAN, NAN};
+			auto number = [&numbers](const char* key){ return numbers.count(key) ? numbers[key] : NAN; };
+			result.time = number("time");
+			result.peakRss = number("peakRss");
+			result.faces = number("faces");
+			result.volume = number("volume");
+			results.push_back(result);
+		}
+		return true;
+	}
+
+	bool readArray(std::vector<Result>& results)
+	{
+		position++;
+		skipSpaces();
+		if(position<end && *position==']')
+		{
+			position++;
+			return true;
+		}
+		while(true)
+		{
+			if(!readValue(results))
+			{
+				return false;
+			}
+			skipSpaces();
+			if(position<end && *position==',')
+			{
+				position++;
+				continue;
+			}
+			if(position<end && *position==']')
+			{
+				position++;
+				return true;
+			}
+			return false;
+		}
+	}
+
+	bool readValue(std::vector<Result>& results)
+	{
+		skipSpaces();
+		if(position==end)
+		{
+			return false;
+		}
+		if(*position=='{')
+		{
+			return readObject(results);
+		}
+		if(*position=='[')
+		{
+			return readArray(results);
+		}
+		if(*position=='"')
+		{
+			std::string text;
+			return readString(text);
+		}
+		for(const char* literal : {"true", "false", "null"})
+		{
+			size_t length = strlen(literal);
+			if((size_t)(end-position)>=length && strncmp(position, literal, length)==0)
+			{
+				position += length;
+				return true;
+			}
+		}
+		double value;
+		return readNumber(value);
+	}
+
+	/** current reading position */
+	const char* position;
+	/** end of the document */
+	const char* end;
+};
+
+//------------------------------------BENCHMARK----------------------------------//
+
+/**
+ * Runs one operation, from the construction of the modeller to the composed solid
+ *
+ * @param solid1 first operand
+ * @param solid2 second operand
+ * @param operation UNION, INTERSECTION or DIFFERENCE
+ * @param classification classification method given to BooleanModeller
+ * @return resulting solid
+ */
+static Solid runOperation(const Solid& solid1, const Solid& solid2, int operation, int classification)
+{
+	BooleanModeller modeller(solid1, solid2, classification);
+	if(operation==UNION)
+	{
+		return modeller.getUnion();
+	}
+	if(operation==INTERSECTION)
+	{
+		return modeller.getIntersection();
+	}
+	return modeller.getDifference();
+}
+
+/**
+ * Compares the results to a baseline and prints every difference
+ *
+ * @param results current results
+ * @param baseline baseline results
+ * @param timeTolerance allowed relative slowdown
+ * @param volumeTolerance allowed relative volume difference
+ * @return number of flagged results
+ */
+static int compare(const std::vector<Result>& results, const std::vector<Result>& baseline, double timeTolerance, double volumeTolerance)
+{
+	int flagged = 0;
+	for(const Result& result : results)
+	{
+		auto found = std::find_if(baseline.begin(), baseline.end(), [&result](const Result& other)
+		{
+			return other.name==result.name && other.operation==result.operation;
+		});
+		if(found==baseline.end())
+		{
+			fprintf(stderr, "NEW        %s %s\n", result.name.c_str(), result.operation.c_str());
+			continue;
+		}
+
+		double change = result.time/found->time-1;
+		if(change>timeTolerance)
+		{
+			fprintf(stderr, "REGRESSION %s %s: %.6fs -> %.6fs (%+.1f%%)\n", result.name.c_str(), result.operation.c_str(), found->time, result.time, change*100);
+			flagged++;
+		}
+		else if(change<-timeTolerance)
+		{
+			fprintf(stderr, "FASTER     %s %s: %.6fs -> %.6fs (%+.1f%%)\n", result.name.c_str(), result.operation.c_str(), found->time, result.time, change*100);
+		}
+
+		double scale = std::max(std::abs(found->volume), std::abs(result.volume));
+		if(!(std::abs(result.volume-found->volume)<=volumeTolerance*scale))
+		{
+			fprintf(stderr, "VOLUME     %s %s: %.12g -> %.12g\n", result.name.c_str(), result.operation.c_str(), found->volume, result.volume);
+			flagged++;
+		}
+		if(result.faces!=found->faces)
+		{
+			fprintf(stderr, "FACES      %s %s: %.0f -> %.0f\n", result.name.c_str(), result.operation.c_str(), found->faces, result.faces);
+		}
+	}
+	return flagged;
+}
+
+int main(int argc, char** argv)
+{
+	std::string outputPath, baselinePath;
+	int repetitions = 3;
+	double timeTolerance = 0.10;
+	double volumeTolerance = 1e-6;
+	int classification = BooleanModeller::RAY_TRACE;
+	std::vector<std::string> paths;
+
+	for(int i=1;i<argc;i++)
+	{
+		std::string argument = argv[i];
+		bool hasValue = i+1<argc;
+		if(argument=="--output" && hasValue)
+		{
+			outputPath = argv[++i];
+		}
+		else if(argument=="--baseline" && hasValue)
+		{
+			baselinePath = argv[++i];
+		}
+		else if(argument=="--repetitions" && hasValue)
+		{
+			repetitions = atoi(argv[++i]);
+		}
+		else if(argument=="--time-tolerance" && hasValue)
+		{
+			timeTolerance = atof(argv[++i]);
+		}
+		else if(argument=="--volume-tolerance" && hasValue)
+		{
+			volumeTolerance = atof(argv[++i]);
+		}
+		else if(argument=="--winding-number")
+		{
+			classification = BooleanModeller::WINDING_NUMBER;
+		}
+		else if(argument.compare(0, 2, "--")!=0)
+		{
+			paths.push_back(argument);
+		}
+		else
+		{
+			paths.clear();
+			break;
+		}
+	}
+	if(paths.empty() || paths.size()%2!=0 || repetitions<1)
+	{
+		fprintf(stderr, "usage: %s [--output FILE] [--baseline FILE] [--repetitions N] [--time-tolerance X] [--volume-tolerance X] [--winding-number] solid1 solid2 [solid1 solid2 ...]\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<Result> results;
+	for(size_t pair=0;pair<paths.size();pair+=2)
+	{
+		Solid solid1, solid2;
+		if(!loadSolid(paths[pair], solid1) || !loadSolid(paths[pair+1], solid2))
+		{
+			fprintf(stderr, "can't read %s or %s\n", paths[pair].c_str(), paths[pair+1].c_str());
+			return 1;
+		}
+		std::string name = getFileName(paths[pair])+"|"+getFileName(paths[pair+1]);
+
+		for(int operation=0;operation<NUM_OPERATIONS;operation++)
+		{
+			Result result = {name, OPERATION_NAMES[operation], INFINITY, 0, 0, 0};
+			for(int i=0;i<repetitions;i++)
+			{
+				resetPeakRss();
+				auto start = std::chrono::steady_clock::now();
+				Solid output = runOperation(solid1, solid2, operation, classification);
+				auto end = std::chrono::steady_clock::now();
+
+				result.time = std::min(result.time, std::chrono::duration<double>(end-start).count());
+				result.peakRss = std::max(result.peakRss, getPeakRss());
+				result.faces = output.getIndices().size()/3;
+				result.volume = output.getVolume();
+			}
+			results.push_back(result);
+		}
+	}
+
+	if(outputPath.empty())
+	{
+		writeResults(std::cout, results);
+	}
+	else
+	{
+		std::ofstream output(outputPath);
+		writeResults(output, results);
+		if(!output)
+		{
+			fprintf(stderr, "can't write %s\n", outputPath.c_str());
+			return 1;
+		}
+	}
+
+	if(!baselinePath.empty())
+	{
+		std::ifstream input(baselinePath, std::ios::binary);
+		std::stringstream text;
+		text<<input.rdbuf();
+		std::vector<Result> baseline;
+		if(!input || !JsonReader(text.str()).read(baseline))
+		{
+			fprintf(stderr, "can't read baseline %s\n", baselinePath.c_str());
+			return 1;
+		}
+		if(compare(results, baseline, timeTolerance, volumeTolerance)>0)
+		{
+			return 2;
+		}
+	}
+	return 0;
+}
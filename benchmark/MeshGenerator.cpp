@@ -0,0 +1,316 @@
+#include "MeshGenerator.hpp"
+#include <array>
+#include <cmath>
+#include <map>
+#include <random>
+#include <tuple>
+
+/**
+ * Procedural closed meshes used as benchmark inputs.
+ * 
+ * @author akatsia-games on github.com
+ */
+
+/**
+ * Generates a UV sphere centered on the origin
+ * 
+ * @param radius sphere radius
+ * @param stacks number of divisions from pole to pole (at least 2)
+ * @param slices number of divisions around the poles (at least 3)
+ * @param color solid color
+ * @return solid with 2*slices*(stacks-1) faces
+ */
+Solid MeshGenerator::sphere(double radius, int stacks, int slices, Colour3f color)
+{
+	std::vector<Point3f> vertices;
+	std::vector<int> indices;
+	
+	vertices.push_back({0.0, 0.0, radius});
+	for(int i=1;i<stacks;i++)
+	{
+		double theta = M_PI*i/stacks;
+		for(int j=0;j<slices;j++)
+		{
+			double phi = 2*M_PI*j/slices;
+			vertices.push_back({radius*sin(theta)*cos(phi), radius*sin(theta)*sin(phi), radius*cos(theta)});
+		}
+	}
+	vertices.push_back({0.0, 0.0, -radius});
+	int south = vertices.size()-1;
+	
+	for(int j=0;j<slices;j++)
+	{
+		indices.insert(indices.end(), {0, 1+j, 1+(j+1)%slices});
+	}
+	for(int i=0;i<stacks-2;i++)
+	{
+		for(int j=0;j<slices;j++)
+		{
+			int a = 1+i*slices+j;
+			int b = 1+i*slices+(j+1)%slices;
+			indices.insert(indices.end(), {a, a+slices, b+slices, a, b+slices, b});
+		}
+	}
+	int last = 1+(stacks-2)*slices;
+	for(int j=0;j<slices;j++)
+	{
+		indices.insert(indices.end(), {south, last+(j+1)%slices, last+j});
+	}
+	
+	Solid solid;
+	solid.setData(vertices, indices, color);
+	return solid;
+}
+
+/**
+ * Generates a cube centered on the origin, each side split in a grid of squares
+ * 
+ * @param size side length
+ * @param subdivisions number of squares along a side
+ * @param color solid color
+ * @return solid with 12*subdivisions^2 faces
+ */
+Solid MeshGenerator::cube(double size, int subdivisions, Colour3f color)
+{
+	std::vector<Point3f> vertices;
+	std::vector<int> indices;
+	std::map<std::tuple<int,int,int>, int> grid;
+	int n = subdivisions;
+	
+	//grid point on the surface, shared by the sides meeting on it
+	auto vertex = [&](int i, int j, int k)
+	{
+		auto inserted = grid.emplace(std::make_tuple(i, j, k), (int)vertices.size());
+		if(inserted.second)
+		{
+			vertices.push_back({size*((double)i/n-0.5), size*((double)j/n-0.5), size*((double)k/n-0.5)});
+		}
+		return inserted.first->second;
+	};
+	
+	//for each side: the fixed axis, its value, and the two axes spanning it in counterclockwise order
+	for(int axis=0;axis<3;axis++)
+	{
+		for(int side=0;side<2;side++)
+		{
+			int u = (axis+1)%3;
+			int v = (axis+2)%3;
+			if(side==0)
+			{
+				std::swap(u, v);
+			}
+			for(int a=0;a<n;a++)
+			{
+				for(int b=0;b<n;b++)
+				{
+					int corners[4];
+					int steps[4][2] = {{0,0}, {1,0}, {1,1}, {0,1}};
+					for(int c=0;c<4;c++)
+					{
+						int coordinates[3];
+						coordinates[axis] = side*n;
+						coordinates[u] = a+steps[c][0];
+						coordinates[v] = b+steps[c][1];
+						corners[c] = vertex(coordinates[0], coordinates[1], coordinates[2]);
+					}
+					indices.insert(indices.end(), {corners[0], corners[1], corners[2], corners[0], corners[2], corners[3]});
+				}
+			}
+		}
+	}
+	
+	Solid solid;
+	solid.setData(vertices, indices, color);
+	return solid;
+}
+
+/**
+ * Generates a torus around the z axis
+ * 
+ * @param majorRadius distance from the center to the tube center
+ * @param minorRadius tube radius
+ * @param majorSegments number of divisions around the z axis
+ * @param minorSegments number of divisions around the tube
+ * @param color solid color
+ * @return solid with 2*majorSegments*minorSegments faces
+ */
+Solid MeshGenerator::torus(double majorRadius, double minorRadius, int majorSegments, int minorSegments, Colour3f color)
+{
+	std::vector<Point3f> vertices;
+	std::vector<int> indices;
+	
+	for(int i=0;i<majorSegments;i++)
+	{
+		double phi = 2*M_PI*i/majorSegments;
+		for(int j=0;j<minorSegments;j++)
+		{
+			double theta = 2*M_PI*j/minorSegments;
+			double distance = majorRadius+minorRadius*cos(theta);
+			vertices.push_back({distance*cos(phi), distance*sin(phi), minorRadius*sin(theta)});
+		}
+	}
+	
+	for(int i=0;i<majorSegments;i++)
+	{
+		int next = (i+1)%majorSegments;
+		for(int j=0;j<minorSegments;j++)
+		{
+			int a = i*minorSegments+j;
+			int b = i*minorSegments+(j+1)%minorSegments;
+			int c = next*minorSegments+j;
+			int d = next*minorSegments+(j+1)%minorSegments;
+			indices.insert(indices.end(), {a, c, d, a, d, b});
+		}
+	}
+	
+	Solid solid;
+	solid.setData(vertices, indices, color);
+	return solid;
+}
+
+/**
+ * Generates a spur gear: a toothed profile extruded along the z axis
+ * 
+ * @param radius root radius of the teeth
+ * @param toothHeight height of the teeth above the root radius
+ * @param thickness extrusion length
+ * @param teeth number of teeth
+ * @param layers number of divisions along the extrusion
+ * @param color solid color
+ * @return solid with 8*teeth*(layers+1) faces
+ */
+Solid MeshGenerator::gear(double radius, double toothHeight, double thickness, int teeth, int layers, Colour3f color)
+{
+	std::vector<Point3f> vertices;
+	std::vector<int> indices;
+	
+	//profile: four points per tooth (root, rise, tip, fall)
+	std::vector<double> profileX, profileY;
+	for(int t=0;t<teeth;t++)
+	{
+		double angles[4] = {0.0, 0.3, 0.45, 0.75};
+		double radii[4] = {radius, radius+toothHeight, radius+toothHeight, radius};
+		for(int k=0;k<4;k++)
+		{
+			double angle = 2*M_PI*(t+angles[k])/teeth;
+			profileX.push_back(radii[k]*cos(angle));
+			profileY.push_back(radii[k]*sin(angle));
+		}
+	}
+	int numProfile = profileX.size();
+	
+	for(int layer=0;layer<=layers;layer++)
+	{
+		double z = thickness*((double)layer/layers-0.5);
+		for(int k=0;k<numProfile;k++)
+		{
+			vertices.push_back({profileX[k], profileY[k], z});
+		}
+	}
+	int bottomCenter = vertices.size();
+	vertices.push_back({0.0, 0.0, -thickness/2});
+	int topCenter = vertices.size();
+	vertices.push_back({0.0, 0.0, thickness/2});
+	
+	for(int layer=0;layer<layers;layer++)
+	{
+		for(int k=0;k<numProfile;k++)
+		{
+			int a = layer*numProfile+k;
+			int b = layer*numProfile+(k+1)%numProfile;
+			indices.insert(indices.end(), {a, b, b+numProfile, a, b+numProfile, a+numProfile});
+		}
+	}
+	
+	//caps: the profile is star shaped around the axis
+	int top = layers*numProfile;
+	for(int k=0;k<numProfile;k++)
+	{
+		int next = (k+1)%numProfile;
+		indices.insert(indices.end(), {bottomCenter, next, k});
+		indices.insert(indices.end(), {topCenter, top+k, top+next});
+	}
+	
+	Solid solid;
+	solid.setData(vertices, indices, color);
+	return solid;
+}
+
+/**
+ * Generates the convex hull of random points on the unit sphere
+ * 
+ * @param numPoints number of points (at least 4)
+ * @param seed random seed
+ * @param color solid color
+ * @return solid with 2*numPoints-4 faces
+ */
+Solid MeshGenerator::convexHull(int numPoints, unsigned int seed, Colour3f color)
+{
+	std::mt19937 random(seed);
+	std::normal_distribution<double> normal;
+	std::vector<Point3f> vertices;
+	for(int i=0;i<numPoints;i++)
+	{
+		Vector3f direction = {normal(random), normal(random), normal(random)};
+		direction.normalize();
+		vertices.push_back(direction);
+	}
+	
+	auto orientation = [&vertices](int a, int b, int c, int d)
+	{
+		Vector3f ab = {vertices[b].x-vertices[a].x, vertices[b].y-vertices[a].y, vertices[b].z-vertices[a].z};
+		Vector3f ac = {vertices[c].x-vertices[a].x, vertices[c].y-vertices[a].y, vertices[c].z-vertices[a].z};
+		Vector3f ad = {vertices[d].x-vertices[a].x, vertices[d].y-vertices[a].y, vertices[d].z-vertices[a].z};
+		Vector3f normal;
+		normal.cross(ab, ac);
+		return normal.dot(ad);
+	};
+	
+	//incremental hull, starting from a tetrahedron with outward faces
+	std::vector<std::array<int,3>> faces;
+	if(orientation(0, 1, 2, 3)>0)
+	{
+		faces = {{0, 2, 1}, {0, 1, 3}, {1, 2, 3}, {2, 0, 3}};
+	}
+	else
+	{
+		faces = {{0, 1, 2}, {0, 3, 1}, {1, 3, 2}, {2, 3, 0}};
+	}
+	for(int p=4;p<numPoints;p++)
+	{
+		std::map<std::pair<int,int>, int> edges;
+		std::vector<std::array<int,3>> kept;
+		for(const std::array<int,3>& face : faces)
+		{
+			if(orientation(face[0], face[1], face[2], p)>1e-12)
+			{
+				for(int k=0;k<3;k++)
+				{
+					edges[{face[k], face[(k+1)%3]}]++;
+				}
+			}
+			else
+			{
+				kept.push_back(face);
+			}
+		}
+		//horizon: edges of visible faces whose twin isn't visible
+		for(const auto& edge : edges)
+		{
+			if(edges.count({edge.first.second, edge.first.first})==0)
+			{
+				kept.push_back({edge.first.first, edge.first.second, p});
+			}
+		}
+		faces.swap(kept);
+	}
+	
+	std::vector<int> indices;
+	for(const std::array<int,3>& face : faces)
+	{
+		indices.insert(indices.end(), face.begin(), face.end());
+	}
+	Solid solid;
+	solid.setData(vertices, indices, color);
+	return solid;
+}
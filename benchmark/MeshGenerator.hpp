@@ -0,0 +1,25 @@
+#ifndef __MESH_GENERATOR__
+#define __MESH_GENERATOR__
+
+#include"Solid.hpp"
+
+/**
+ * Procedural closed meshes used as benchmark inputs. Every generator takes a resolution
+ * parameter so the same shape can be produced at increasing face counts.
+ * 
+ * @author akatsia-games on github.com
+ */
+class MeshGenerator
+{
+public:
+	static Solid sphere(double radius, int stacks, int slices, Colour3f color);
+
+	static Solid cube(double size, int subdivisions, Colour3f color);
+
+	static Solid torus(double majorRadius, double minorRadius, int majorSegments, int minorSegments, Colour3f color);
+
+	static Solid gear(double radius, double toothHeight, double thickness, int teeth, int layers, Colour3f color);
+
+	static Solid convexHull(int numPoints, unsigned int seed, Colour3f color);
+};
+#endif //__MESH_GENERATOR__
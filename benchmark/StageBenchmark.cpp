@@ -0,0 +1,285 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "BooleanModeller.hpp"
+#include "CoordinateFile.hpp"
+#include "EdgeCollapser.hpp"
+#include "MeshGenerator.hpp"
+#include "Object3D.hpp"
+#include "SolidWriter.hpp"
+
+/**
+ * Stage level microbenchmark: times every stage of a boolean operation (Object3D construction,
+ * face splitting, face classification, composition) and Solid I/O on procedural inputs of
+ * increasing size. Reports faces per second and the scaling exponent of each stage, i.e. the
+ * slope of log(time) against log(faces).
+ * 
+ * <br><br>The slivers of the union of the largest inputs are counted with and without the
+ * sliver collapse (see BooleanModeller::setSliverCollapse); the exit status is 2 if the
+ * collapse left as many.
+ * 
+ * <br><br>Usage: StageBenchmark [levels] [repetitions] [case]
+ * 
+ * @author akatsia-games on github.com
+ */
+
+/** stages measured for each input */
+static const int CONSTRUCT = 0;
+static const int SPLIT = 1;
+static const int CLASSIFY = 2;
+static const int COMPOSE = 3;
+static const int WRITE = 4;
+static const int READ = 5;
+static const int NUM_STAGES = 6;
+
+static const char* STAGE_NAMES[NUM_STAGES] = {"construct", "split", "classify", "compose", "write", "read"};
+
+/** sliver collapse settings checked: quality, edge length and volume change */
+static const double SLIVER_QUALITY = 0.1;
+static const double SLIVER_EDGE_LENGTH = 1e-3;
+static const double SLIVER_VOLUME_CHANGE = 1e-6;
+
+/** input generator: pair of overlapping solids at a given resolution level */
+struct Case
+{
+	const char* name;
+	std::function<Solid(int)> generate;
+};
+
+/**
+ * Runs a function the given number of times
+ * 
+ * @param repetitions number of runs
+ * @param prepare called before each run, not timed
+ * @param function timed function
+ * @return shortest run time in seconds
+ */
+static double measure(int repetitions, const std::function<void()>& prepare, const std::function<void()>& function)
+{
+	double best = INFINITY;
+	for(int i=0;i<repetitions;i++)
+	{
+		prepare();
+		auto start = std::chrono::steady_clock::now();
+		function();
+		auto end = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double>(end-start).count());
+	}
+	return best;
+}
+
+/**
+ * Fits log(time) = exponent*log(faces) + constant by least squares
+ * 
+ * @param faces input face counts
+ * @param times stage times
+ * @return scaling exponent, NAN if there are fewer than two usable points
+ */
+static double scalingExponent(const std::vector<double>& faces, const std::vector<double>& times)
+{
+	double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+	int count = 0;
+	for(size_t i=0;i<faces.size();i++)
+	{
+		if(times[i]>0)
+		{
+			double x = log(faces[i]);
+			double y = log(times[i]);
+			sumX += x;
+			sumY += y;
+			sumXX += x*x;
+			sumXY += x*y;
+			count++;
+		}
+	}
+	double denominator = count*sumXX-sumX*sumX;
+	if(count<2 || denominator<=0)
+	{
+		return NAN;
+	}
+	return (count*sumXY-sumX*sumY)/denominator;
+}
+
+/**
+ * Counts the triangles of a solid the sliver collapse takes as bad
+ * 
+ * @param solid solid checked
+ * @return number of triangles of low quality or with a short edge
+ */
+static int countSlivers(const Solid& solid)
+{
+	const std::vector<Point3f>& vertices = solid.getVertices();
+	const std::vector<int>& indices = solid.getIndices();
+	int slivers = 0;
+	for(size_t i=0;i+2<indices.size();i+=3)
+	{
+		const Point3f& p1 = vertices[indices[i]];
+		const Point3f& p2 = vertices[indices[i+1]];
+		const Point3f& p3 = vertices[indices[i+2]];
+		double shortest = std::min(std::min(p1.distance(p2), p2.distance(p3)), p3.distance(p1));
+		if(shortest<SLIVER_EDGE_LENGTH || EdgeCollapser::getQuality(p1, p2, p3)<SLIVER_QUALITY)
+		{
+			slivers++;
+		}
+	}
+	return slivers;
+}
+
+/**
+ * Times every stage for one pair of solids
+ * 
+ * @param solid1 first operand
+ * @param solid2 second operand
+ * @param repetitions runs per stage
+ * @param times output, time in seconds per stage
+ */
+static void runStages(const Solid& solid1, const Solid& solid2, int repetitions, double times[NUM_STAGES])
+{
+	//faces refer to their object's vertex array, so objects are rebuilt instead of copied
+	std::unique_ptr<Object3D> object1, object2;
+	auto construct = [&]()
+	{
+		object1.reset(new Object3D(solid1));
+		object2.reset(new Object3D(solid2));
+	};
+	auto split = [&]()
+	{
+		object1->splitFaces(*object2);
+		object2->splitFaces(*object1);
+	};
+	
+	times[CONSTRUCT] = measure(repetitions, [&](){ object1.reset(); object2.reset(); }, construct);
+	
+	times[SPLIT] = measure(repetitions, construct, split);
+	
+	times[CLASSIFY] = measure(repetitions, [&](){ construct(); split(); }, [&]()
+	{
+		object1->classifyFaces(*object2);
+		object2->classifyFaces(*object1);
+	});
+	
+	BooleanModeller modeller(solid1, solid2);
+	Solid result;
+	times[COMPOSE] = measure(repetitions, [](){}, [&]()
+	{
+		result = modeller.getUnion();
+	});
+	
+	std::string text;
+	times[WRITE] = measure(repetitions, [](){}, [&]()
+	{
+		std::ostringstream output;
+		SolidWriter::write(solid1, output, SolidWriter::COORDINATES);
+		SolidWriter::write(solid2, output, SolidWriter::COORDINATES);
+		text = output.str();
+	});
+	
+	std::string text1, text2;
+	{
+		std::ostringstream output1, output2;
+		SolidWriter::write(solid1, output1, SolidWriter::COORDINATES);
+		SolidWriter::write(solid2, output2, SolidWriter::COORDINATES);
+		text1 = output1.str();
+		text2 = output2.str();
+	}
+	times[READ] = measure(repetitions, [](){}, [&]()
+	{
+		Solid read1, read2;
+		CoordinateFile::parse(text1.data(), text1.data()+text1.size(), read1, {0.5, 0.5, 0.5});
+		CoordinateFile::parse(text2.data(), text2.data()+text2.size(), read2, {0.5, 0.5, 0.5});
+	});
+}
+
+int main(int argc, char** argv)
+{
+	int levels = argc>1 ? atoi(argv[1]) : 4;
+	int repetitions = argc>2 ? atoi(argv[2]) : 3;
+	const char* filter = argc>3 ? argv[3] : nullptr;
+	if(levels<1 || repetitions<1)
+	{
+		fprintf(stderr, "usage: %s [levels] [repetitions] [case]\n", argv[0]);
+		return 1;
+	}
+	
+	Colour3f color = {0.5, 0.5, 0.5};
+	//each level doubles the number of faces
+	auto resolution = [](double base, int level){ return (int)std::lround(base*pow(2.0, level/2.0)); };
+	std::vector<Case> cases = {
+		{"sphere", [&](int level){ int r = resolution(6, level); return MeshGenerator::sphere(1.0, r, 2*r, color); }},
+		{"cube", [&](int level){ return MeshGenerator::cube(1.0, resolution(3, level), color); }},
+		{"torus", [&](int level){ int r = resolution(6, level); return MeshGenerator::torus(1.0, 0.35, 2*r, r, color); }},
+		{"gear", [&](int level){ int r = resolution(4, level); return MeshGenerator::gear(1.0, 0.2, 0.5, 2*r, r, color); }},
+		{"hull", [&](int level){ return MeshGenerator::convexHull(32*(1<<level)+2, 7, color); }},
+	};
+	
+	printf("%-8s %8s", "case", "faces");
+	for(int stage=0;stage<NUM_STAGES;stage++)
+	{
+		printf(" %12s", STAGE_NAMES[stage]);
+	}
+	printf(" %14s\n", "faces/s");
+	
+	int flagged = 0;
+	for(const Case& current : cases)
+	{
+		if(filter!=nullptr && strcmp(filter, current.name)!=0)
+		{
+			continue;
+		}
+		std::vector<double> faces;
+		std::vector<double> stageTimes[NUM_STAGES];
+		for(int level=0;level<levels;level++)
+		{
+			Solid solid1 = current.generate(level);
+			Solid solid2 = current.generate(level);
+			solid2.translate(0.31, 0.17, 0.07);
+			double numFaces = (solid1.getIndices().size()+solid2.getIndices().size())/3;
+			
+			double times[NUM_STAGES];
+			runStages(solid1, solid2, repetitions, times);
+			
+			double total = 0;
+			printf("%-8s %8.0f", current.name, numFaces);
+			for(int stage=0;stage<NUM_STAGES;stage++)
+			{
+				printf(" %10.3fms", times[stage]*1e3);
+				stageTimes[stage].push_back(times[stage]);
+			}
+			for(int stage=CONSTRUCT;stage<=COMPOSE;stage++)
+			{
+				total += times[stage];
+			}
+			printf(" %14.0f\n", numFaces/total);
+			faces.push_back(numFaces);
+		}
+		
+		printf("%-8s %8s", current.name, "exponent");
+		for(int stage=0;stage<NUM_STAGES;stage++)
+		{
+			printf(" %12.2f", scalingExponent(faces, stageTimes[stage]));
+		}
+		printf("\n");
+		
+		Solid solid1 = current.generate(levels-1);
+		Solid solid2 = current.generate(levels-1);
+		solid2.translate(0.31, 0.17, 0.07);
+		BooleanModeller modeller(solid1, solid2);
+		Solid plain = modeller.getUnion();
+		modeller.setSliverCollapse(SLIVER_QUALITY, SLIVER_EDGE_LENGTH, SLIVER_VOLUME_CHANGE);
+		Solid collapsed = modeller.getUnion();
+		int slivers = countSlivers(plain);
+		int collapsedSlivers = countSlivers(collapsed);
+		bool reduced = slivers==0 || collapsedSlivers<slivers;
+		printf("%-8s %8s %d of %zu faces, %d of %zu after the collapse%s\n", current.name, "slivers", slivers, plain.getIndices().size()/3,
+			collapsedSlivers, collapsed.getIndices().size()/3, reduced ? "" : " NOT REDUCED");
+		flagged += !reduced;
+	}
+	return flagged>0 ? 2 : 0;
+}